@@ -0,0 +1,211 @@
+#include <process_timing/accumulating_timing.hpp>
+#include <process_timing/batch_statistics.hpp>
+#include <process_timing/bench.hpp>
+#include <process_timing/clock_anchor.hpp>
+#include <process_timing/coarse_clock.hpp>
+#include <process_timing/cpu_clock.hpp>
+#include <process_timing/deadline.hpp>
+#include <process_timing/latency_histogram.hpp>
+#include <process_timing/perf_counters.hpp>
+#include <process_timing/process_timing.hpp>
+#include <process_timing/sampled_timing.hpp>
+#include <process_timing/scoped_timing.hpp>
+#include <process_timing/stage_timing.hpp>
+#include <process_timing/streaming_statistics.hpp>
+#include <process_timing/timing_registry.hpp>
+#include <process_timing/tsc_clock.hpp>
+#include <process_timing/zones.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace timings;
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner(argc, argv);
+
+    runner.run("steady_clock::now", [] {
+        bench::DoNotOptimize(std::chrono::steady_clock::now());
+    });
+    runner.run("system_clock::now", [] {
+        bench::DoNotOptimize(std::chrono::system_clock::now());
+    });
+    runner.run("high_resolution_clock::now", [] {
+        bench::DoNotOptimize(std::chrono::high_resolution_clock::now());
+    });
+#if defined(PROCESS_TIMING_HAS_CPU_CLOCKS)
+    runner.run("ThreadCpuClock::now", [] {
+        bench::DoNotOptimize(ThreadCpuClock::now());
+    });
+    runner.run("ProcessCpuClock::now", [] {
+        bench::DoNotOptimize(ProcessCpuClock::now());
+    });
+#endif
+#if defined(PROCESS_TIMING_HAS_TSC_CLOCK)
+    runner.run<TscClock>("TscClock::now", [] {
+        bench::DoNotOptimize(TscClock::now());
+    });
+#endif
+#if defined(PROCESS_TIMING_HAS_COARSE_MONOTONIC_CLOCK)
+    runner.run("CoarseMonotonicClock::now", [] {
+        bench::DoNotOptimize(CoarseMonotonicClock::now());
+    });
+#endif
+    {
+        CoarseClockTicker ticker(std::chrono::microseconds(100));
+        runner.run("CoarseClock::now", [] {
+            bench::DoNotOptimize(CoarseClock::now());
+        });
+        BasicProcessTiming<CoarseClock> coarse;
+        runner.run("BasicProcessTiming<CoarseClock>::start+stop", [&] {
+            coarse.start();
+            coarse.stop();
+        });
+    }
+
+    ProcessTiming shared;
+    runner.run("ProcessTiming::start+stop", [&] {
+        shared.start();
+        shared.stop();
+    });
+    LocalProcessTiming local;
+    runner.run("LocalProcessTiming::start+stop", [&] {
+        local.start();
+        local.stop();
+    });
+    runner.run("ProcessTiming::elapsed", [&] {
+        bench::DoNotOptimize(shared.elapsed());
+    });
+#if defined(PROCESS_TIMING_HAS_PERF_COUNTERS)
+    if (PerfCounterGroup::Local().isAvailable()) {
+        PerfTiming perf;
+        runner.run("PerfTiming::start+stop", [&] {
+            perf.start();
+            perf.stop();
+        });
+    }
+#endif
+
+    const std::chrono::hours budget(1);
+    runner.run("ProcessTiming::elapsed() < budget", [&] {
+        bench::DoNotOptimize(shared.isRunning() && shared.elapsed() < budget);
+    });
+    Deadline deadline(shared, budget);
+    runner.run("Deadline::expired", [&] {
+        bench::DoNotOptimize(deadline.expired());
+    });
+    CoarseDeadline coarse(deadline, 64);
+    runner.run("CoarseDeadline::expired (64)", [&] {
+        bench::DoNotOptimize(coarse.expired());
+    });
+
+    // Eight pipeline stages, with a timing per stage or a single stage timing.
+    LocalProcessTiming perStage[8];
+    runner.run("LocalProcessTiming::start+stop x8", [&] {
+        for (LocalProcessTiming &timing : perStage) {
+            timing.start();
+            timing.stop();
+        }
+    });
+    StageTiming<8> stages;
+    runner.run("StageTiming<8>::start+next x8", [&] {
+        stages.start();
+        for (int stage = 0; stage < 8; ++stage)
+            stages.next();
+    });
+    static StageBreakdown<8> breakdown;
+    runner.run("StageTiming<8>::record(breakdown)", [&] {
+        stages.record(breakdown);
+    });
+
+    AccumulatingTiming accumulating;
+    runner.run("AccumulatingTiming::lap", [&] {
+        bench::DoNotOptimize(accumulating.lap());
+    });
+
+    LatencyHistogram histogram;
+    std::chrono::nanoseconds latency(1);
+    runner.run("LatencyHistogram::record", [&] {
+        histogram.record(latency);
+        latency = std::chrono::nanoseconds((latency.count() * 7 + 13) & 0xFFFFF);
+    });
+    runner.run("ProcessTiming::stop(histogram)", [&] {
+        shared.start();
+        shared.stop(histogram);
+    });
+    RunningStatistics running;
+    runner.run("RunningStatistics::record", [&] {
+        running.record(latency);
+    });
+    MovingAverage average(0.01);
+    runner.run("MovingAverage::record", [&] {
+        average.record(latency);
+    });
+    static WindowedHistogram window;
+    runner.run("WindowedHistogram::record", [&] {
+        window.record(latency);
+    });
+    RegisteredTimer timer = TimingRegistry::Register("bench");
+    runner.run("RegisteredTimer::record", [&] {
+        timer.record(latency);
+    });
+
+    NullSink null;
+    runner.run("PROCESS_TIMING_SCOPE(NullSink)", [&] {
+        PROCESS_TIMING_SCOPE(null);
+    });
+    runner.run("PROCESS_TIMING_SAMPLED_SCOPE(histogram, 64)", [&] {
+        PROCESS_TIMING_SAMPLED_SCOPE(histogram, 64);
+    });
+    runner.run("PROCESS_TIMING_GEOMETRIC_SCOPE(histogram, 64)", [&] {
+        PROCESS_TIMING_GEOMETRIC_SCOPE(histogram, 64);
+    });
+    runner.run("PROCESS_TIMING_ZONE", [] {
+        PROCESS_TIMING_ZONE("bench");
+    });
+
+    // Batch kernels over a million values, for every instruction set the CPU supports.
+    std::vector<std::int64_t> values(1 << 20);
+    for (std::size_t i = 0; i < values.size(); ++i)
+        values[i] = static_cast<std::int64_t>((i * 2654435761u) % 100000);
+    std::vector<std::int64_t> nanoseconds(values.size());
+    const char *levelNames[] = { "scalar", "neon", "avx2", "avx512" };
+    for (SimdLevel level : { SimdLevel::Scalar, SimdLevel::Neon, SimdLevel::Avx2, SimdLevel::Avx512 }) {
+        // AVX-512 CPUs also run AVX2, the other levels are exclusive.
+        bool supported = level == SimdLevel::Scalar || level == SupportedSimdLevel() ||
+                         (level == SimdLevel::Avx2 && SupportedSimdLevel() == SimdLevel::Avx512);
+        if (!supported)
+            continue;
+        std::string suffix = std::string(" (1M, ") + levelNames[static_cast<int>(level)] + ")";
+        runner.run("ComputeStatistics" + suffix, [&] {
+            bench::DoNotOptimize(ComputeStatistics(values.data(), values.size(), level));
+        });
+        runner.run("TicksToNanoseconds" + suffix, [&] {
+            TicksToNanoseconds(reinterpret_cast<const std::uint64_t*>(values.data()), nanoseconds.data(), values.size(), 0x155555555u, 32, level);
+            bench::DoNotOptimize(nanoseconds.data());
+        });
+        runner.run("CountBuckets" + suffix, [&] {
+            HistogramSnapshot<5> snapshot;
+            CountBuckets(values.data(), values.size(), snapshot, level);
+            bench::DoNotOptimize(snapshot);
+        });
+    }
+
+    // Increasing ticks over nine anchors, mapped in a single pass.
+    std::vector<ClockAnchor> anchors;
+    for (std::int64_t i = 0; i < 9; ++i)
+        anchors.push_back(ClockAnchor{ i * 12500, 1000000000 + i * 12501, 0 });
+    ClockTimeline timeline(anchors);
+    std::vector<std::int64_t> ticks(values.size());
+    for (std::size_t i = 0; i < ticks.size(); ++i)
+        ticks[i] = static_cast<std::int64_t>(i / 10);
+    runner.run("ClockTimeline::toWall (1M)", [&] {
+        timeline.toWall(ticks.data(), nanoseconds.data(), ticks.size());
+        bench::DoNotOptimize(nanoseconds.data());
+    });
+
+    return 0;
+}
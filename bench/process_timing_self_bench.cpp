@@ -0,0 +1,173 @@
+#include <process_timing/bench.hpp>
+#include <process_timing/padded_timing.hpp>
+#include <process_timing/process_timing.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace timings;
+
+namespace {
+
+    /**
+     *    @brief Run one function per thread for the sample time of each sample, and add the mean time per call to the
+     *    runner, over the window measured from all threads ready to all stopped. If readers is true, thread 0 runs the
+     *    writer and the others the reader, and the writer and reader times are added as separate results; otherwise all
+     *    run the writer on their own index.
+     */
+    template < class Writer, class Reader >
+    void Contended(bench::Runner &runner, const std::string &name, unsigned threads, const bench::Options &options, bool readers, Writer writer, Reader reader)
+    {
+        const std::size_t groups = readers ? 2 : 1;
+        std::vector<bench::Result> results(groups);
+        for (std::size_t g = 0; g < groups; ++g) {
+            results[g].name = readers ? name + (g == 0 ? " (writer)" : " (readers)") : name;
+            results[g].iterations = 0;
+            results[g].overhead = 0.0;
+        }
+
+        for (std::size_t s = 0; s < options.samples; ++s) {
+            std::atomic<unsigned> ready(0);
+            std::atomic<bool> go(false);
+            std::atomic<bool> running(true);
+            std::vector<std::uint64_t> calls(threads, 0);
+            std::vector<std::chrono::steady_clock::time_point> stops(threads);
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t] {
+                    std::uint64_t n = 0;
+                    ready.fetch_add(1);
+                    while (!go.load())
+                        ;
+                    while (running.load(std::memory_order_relaxed)) {
+                        for (int i = 0; i < 64; ++i) {
+                            if (t == 0 || !readers)
+                                writer(t);
+                            else
+                                reader(t);
+                        }
+                        n += 64;
+                    }
+                    stops[t] = std::chrono::steady_clock::now();
+                    calls[t] = n;
+                });
+            }
+            while (ready.load() != threads)
+                ;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            go.store(true);
+            std::this_thread::sleep_for(options.sampleTime);
+            running.store(false);
+            for (std::thread &worker : workers)
+                worker.join();
+
+            const double window = std::chrono::duration<double,std::nano>(*std::max_element(stops.begin(), stops.end()) - start).count();
+            for (std::size_t g = 0; g < groups; ++g) {
+                unsigned first = readers && g == 1 ? 1 : 0;
+                unsigned last = readers && g == 0 ? 1 : threads;
+                std::uint64_t total = 0;
+                for (unsigned t = first; t < last; ++t)
+                    total += calls[t];
+                results[g].iterations = std::max(results[g].iterations, total);
+                results[g].samples.push_back(window * (last - first) / static_cast<double>(std::max<std::uint64_t>(total, 1)));
+            }
+        }
+
+        for (bench::Result &result : results) {
+            bench::Summarize(result);
+            runner.add(result);
+        }
+    }
+
+    template < class Timing >
+    void Methods(bench::Runner &runner, const std::string &prefix)
+    {
+        Timing timing;
+        runner.run(prefix + "::start", [&] { timing.start(); });
+        runner.run(prefix + "::stop", [&] { timing.stop(); });
+        timing.start();
+        runner.run(prefix + "::isRunning", [&] { bench::DoNotOptimize(timing.isRunning()); });
+        runner.run(prefix + "::elapsed (running)", [&] { bench::DoNotOptimize(timing.elapsed()); });
+        timing.stop();
+        runner.run(prefix + "::elapsed (stopped)", [&] { bench::DoNotOptimize(timing.elapsed()); });
+        runner.run(prefix + "::getStartTime", [&] { bench::DoNotOptimize(timing.getStartTime()); });
+        runner.run(prefix + "::to_string", [&] { bench::DoNotOptimize(timing.to_string()); });
+        char buffer[TimeString::Capacity];
+        runner.run(prefix + "::to_chars", [&] {
+            bench::DoNotOptimize(timing.to_chars(buffer, sizeof(buffer)));
+            bench::DoNotOptimize(buffer);
+        });
+        runner.run(prefix + "::to_time_string", [&] { bench::DoNotOptimize(timing.to_time_string()); });
+    }
+
+    template < class Rep, class Period >
+    void Formatting(bench::Runner &runner, const std::string &period)
+    {
+        // An hour and a bit, so that every time element is printed.
+        const std::chrono::duration<Rep,Period> duration = std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(
+            std::chrono::nanoseconds(3723004005006LL));
+        std::string str;
+        runner.run("TimeToString<" + period + ">", [&] {
+            ProcessTimingBase::TimeToString(duration, str);
+            bench::DoNotOptimize(str);
+        });
+        char buffer[TimeString::Capacity];
+        runner.run("TimeToChars<" + period + ">", [&] {
+            bench::DoNotOptimize(ProcessTimingBase::TimeToChars(duration, buffer, sizeof(buffer)));
+            bench::DoNotOptimize(buffer);
+        });
+    }
+
+}
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner(argc, argv);
+
+    Methods<ProcessTiming>(runner, "ProcessTiming");
+    Methods<LocalProcessTiming>(runner, "LocalProcessTiming");
+
+    Formatting<std::chrono::nanoseconds::rep, std::nano>(runner, "nano");
+    Formatting<std::chrono::microseconds::rep, std::micro>(runner, "micro");
+    Formatting<std::chrono::milliseconds::rep, std::milli>(runner, "milli");
+    Formatting<std::chrono::seconds::rep, std::ratio<1>>(runner, "seconds");
+    Formatting<std::chrono::minutes::rep, std::ratio<60>>(runner, "minutes");
+    Formatting<std::chrono::hours::rep, std::ratio<3600>>(runner, "hours");
+    Formatting<double, std::milli>(runner, "double milli");
+
+    bench::Options contended = runner.options();
+    contended.samples = std::max<std::size_t>(1, contended.samples / 3);
+    const unsigned maxThreads = std::max(2u, std::thread::hardware_concurrency());
+    for (unsigned threads = 2; ; threads = std::min(threads * 2, maxThreads)) {
+        // One writer restarting a timing while the other threads poll it.
+        std::string name = "shared timing, 1 writer + " + std::to_string(threads - 1) + " readers";
+        if (runner.selected(name)) {
+            ProcessTiming shared;
+            Contended(runner, name, threads, contended, true,
+                      [&](unsigned) { shared.start(); shared.stop(); },
+                      [&](unsigned) { bench::DoNotOptimize(shared.isRunning()); bench::DoNotOptimize(shared.elapsed()); });
+        }
+        // Every thread restarting its own timing, stored next to the others'.
+        name = "adjacent timings, " + std::to_string(threads) + " writers";
+        if (runner.selected(name)) {
+            std::vector<ProcessTiming> timings(threads);
+            auto own = [&](unsigned t) { timings[t].start(); timings[t].stop(); };
+            Contended(runner, name, threads, contended, false, own, own);
+        }
+        name = "adjacent padded timings, " + std::to_string(threads) + " writers";
+        if (runner.selected(name)) {
+            std::vector<PaddedProcessTiming> timings(threads);
+            auto own = [&](unsigned t) { timings[t].start(); timings[t].stop(); };
+            Contended(runner, name, threads, contended, false, own, own);
+        }
+        if (threads == maxThreads)
+            break;
+    }
+
+    return 0;
+}
@@ -0,0 +1,239 @@
+#ifndef process_timing_accumulating_timing_hpp
+#define process_timing_accumulating_timing_hpp
+
+#include "process_timing.hpp"
+
+namespace timings {
+
+    /**
+     *    @brief The BasicAccumulatingTiming class sums up the durations of repeated timings (laps), keeping their count,
+     *    minimum and maximum in place.
+     *
+     *    A lap is timed by start() and stop(), or by successive lap() calls, which take a single clock read each.
+     *    pause() and resume() suspend the current lap without completing it. A bias, e.g. the clock overhead measured by
+     *    CalibrateClock(), can be set to be subtracted from each lap timed by the object itself.
+     *    Objects are meant to be used by a single thread.
+     */
+    template < class ClockType >
+    class BasicAccumulatingTiming : public ProcessTimingBase {
+    public:
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+        using Duration  = typename Clock::duration;
+
+        /**
+         *    @brief Default constructor. The timing is not running.
+         */
+        BasicAccumulatingTiming() : _bias(Duration::zero())
+        {
+            reset();
+        }
+
+        /**
+         *    @brief Set the bias subtracted, clamping at zero, from the laps completed by stop() and lap(); the laps added
+         *    by record() are taken as they are. It is kept by reset().
+         */
+        template < typename Rep, typename Period >
+        inline void setBias(const std::chrono::duration<Rep,Period> &bias)
+        {
+            _bias = std::chrono::duration_cast<Duration>(bias);
+        }
+
+        /**
+         *    @brief Return the bias subtracted from the laps timed by the object.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> bias() const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(_bias);
+        }
+
+        /**
+         *    @brief Forget all the laps and stop counting.
+         */
+        inline void reset()
+        {
+            _ongoing = false;
+            _lapStart = TimePoint();
+            _lapElapsed = Duration::zero();
+            _total = Duration::zero();
+            _min = Duration::max();
+            _max = Duration::zero();
+            _count = 0;
+        }
+
+        /**
+         *    @brief Begin a new lap.
+         */
+        inline void start()
+        {
+            _lapElapsed = Duration::zero();
+            _lapStart = Clock::now();
+            _ongoing = true;
+        }
+
+        /**
+         *    @brief Complete the current lap, if any, and stop counting.
+         */
+        inline void stop()
+        {
+            if (_ongoing) {
+                add(detail::SubtractBias(_lapElapsed + (Clock::now() - _lapStart), _bias));
+                _ongoing = false;
+            } else if (_lapElapsed != Duration::zero()) {
+                add(detail::SubtractBias(_lapElapsed, _bias));
+            }
+            _lapElapsed = Duration::zero();
+        }
+
+        /**
+         *    @brief Complete the current lap, if any, and begin the next one, with a single clock read.
+         *    @return The duration of the completed lap, or zero if there was none.
+         */
+        inline Duration lap()
+        {
+            TimePoint now = Clock::now();
+            Duration duration = detail::SubtractBias(_lapElapsed + (_ongoing ? now - _lapStart : Duration::zero()), _bias);
+            if (_ongoing || _lapElapsed != Duration::zero())
+                add(duration);
+            _lapElapsed = Duration::zero();
+            _lapStart = now;
+            _ongoing = true;
+            return duration;
+        }
+
+        /**
+         *    @brief Suspend the current lap, without completing it.
+         */
+        inline void pause()
+        {
+            if (_ongoing) {
+                _lapElapsed += Clock::now() - _lapStart;
+                _ongoing = false;
+            }
+        }
+
+        /**
+         *    @brief Resume the current lap suspended by pause().
+         */
+        inline void resume()
+        {
+            if (!_ongoing) {
+                _lapStart = Clock::now();
+                _ongoing = true;
+            }
+        }
+
+        /**
+         *    @brief Add a lap taken elsewhere.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            add(std::chrono::duration_cast<Duration>(duration));
+        }
+
+        /**
+         *    @brief Add a lap taken elsewhere and standing for weight laps of the same duration, e.g. one sample out of
+         *    weight timed sections.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight)
+        {
+            add(std::chrono::duration_cast<Duration>(duration), weight);
+        }
+
+        /**
+         *    @brief Returns if a lap is being counted.
+         */
+        inline bool isRunning() const
+        {
+            return _ongoing;
+        }
+
+        /**
+         *    @brief Return the number of completed laps.
+         */
+        inline std::uint64_t count() const
+        {
+            return _count;
+        }
+
+        /**
+         *    @brief Return the total duration of the completed laps.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> total() const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(_total);
+        }
+
+        /**
+         *    @brief Return the shortest completed lap, or zero if there is none.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> min() const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(_count > 0 ? _min : Duration::zero());
+        }
+
+        /**
+         *    @brief Return the longest completed lap, or zero if there is none.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> max() const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(_max);
+        }
+
+        /**
+         *    @brief Return the average duration of the completed laps, or zero if there is none.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> mean() const
+        {
+            if (_count == 0)
+                return std::chrono::duration<Rep,Period>::zero();
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(std::chrono::duration<double,typename Duration::period>(_total) / static_cast<double>(_count));
+        }
+
+        /**
+         *    @brief Return a string representation of the total duration of the completed laps.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::string to_string() const
+        {
+            std::string timeStr;
+            TimeToString<Rep,Period>(total<Rep,Period>(), timeStr);
+            return timeStr;
+        }
+
+    private:
+        inline void add(Duration duration, std::uint64_t weight = 1)
+        {
+            _total += duration * static_cast<typename Duration::rep>(weight);
+            if (duration < _min)
+                _min = duration;
+            if (duration > _max)
+                _max = duration;
+            _count += weight;
+        }
+
+        bool            _ongoing;       ///< Tells if a lap is being counted.
+        TimePoint       _lapStart;      ///< The time point the current lap was started or resumed at.
+        Duration        _lapElapsed;    ///< The duration of the current lap before the last pause.
+        Duration        _total;         ///< The total duration of the completed laps.
+        Duration        _min;           ///< The shortest completed lap.
+        Duration        _max;           ///< The longest completed lap.
+        std::uint64_t   _count;         ///< The number of completed laps.
+        Duration        _bias;          ///< The duration subtracted from the laps timed by the object.
+    };
+
+
+
+    /// The default accumulating timing class, measuring with std::chrono::steady_clock.
+    using AccumulatingTiming = BasicAccumulatingTiming<std::chrono::steady_clock>;
+
+}
+
+#endif // process_timing_accumulating_timing_hpp
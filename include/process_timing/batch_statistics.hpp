@@ -0,0 +1,475 @@
+#ifndef process_timing_batch_statistics_hpp
+#define process_timing_batch_statistics_hpp
+
+#include "latency_histogram.hpp"
+#include "tsc_clock.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    #define PROCESS_TIMING_SIMD_X86 1
+    #include <immintrin.h>
+    #define PROCESS_TIMING_TARGET_AVX2 __attribute__((target("avx2")))
+    #define PROCESS_TIMING_TARGET_AVX512 __attribute__((target("avx512f,avx512dq,avx512cd")))
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    #define PROCESS_TIMING_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+namespace timings {
+
+    /**
+     *    @brief The SimdLevel enum tells which instruction set the batch kernels use.
+     */
+    enum class SimdLevel {
+        Scalar, ///< Portable scalar code.
+        Neon,   ///< ARM64 Advanced SIMD.
+        Avx2,   ///< x86 AVX2.
+        Avx512  ///< x86 AVX-512 F, DQ and CD.
+    };
+
+
+
+    /**
+     *    @brief The BatchStatistics struct holds the reductions of an array of values.
+     */
+    struct BatchStatistics {
+        std::size_t     count;      ///< The number of values.
+        std::int64_t    sum;        ///< The sum of the values, saturated to the range of 64 bits integers.
+        std::int64_t    min;        ///< The smallest value, or zero if there is none.
+        std::int64_t    max;        ///< The largest value, or zero if there is none.
+        double          mean;       ///< The mean of the values.
+        double          variance;   ///< The population variance of the values.
+    };
+
+
+
+    namespace detail {
+
+        /**
+         *    @brief The StatisticsPartial struct accumulates the reductions of a kernel; deviations and squares are of the
+         *    values minus shift, with deviations summed modulo 2^64.
+         */
+        struct StatisticsPartial {
+            std::uint64_t   deviations;
+            std::int64_t    min;
+            std::int64_t    max;
+            double          squares;
+        };
+
+        inline void StatisticsScalar(const std::int64_t *values, std::size_t count, std::int64_t shift, StatisticsPartial &partial)
+        {
+            for (std::size_t i = 0; i < count; ++i) {
+                std::int64_t value = values[i];
+                std::uint64_t deviation = static_cast<std::uint64_t>(value) - static_cast<std::uint64_t>(shift);
+                partial.deviations += deviation;
+                partial.min = value < partial.min ? value : partial.min;
+                partial.max = value > partial.max ? value : partial.max;
+                double square = static_cast<double>(static_cast<std::int64_t>(deviation));
+                partial.squares += square * square;
+            }
+        }
+
+        inline void TicksToNanosecondsScalar(const std::uint64_t *ticks, std::int64_t *nanoseconds, std::size_t count,
+                                             std::uint64_t multiplier, unsigned shift)
+        {
+            for (std::size_t i = 0; i < count; ++i) {
+#if defined(__SIZEOF_INT128__)
+                __extension__ typedef unsigned __int128 Wide;
+                nanoseconds[i] = static_cast<std::int64_t>((static_cast<Wide>(ticks[i]) * multiplier) >> shift);
+#else
+                std::uint64_t tl = ticks[i] & 0xFFFFFFFFu, th = ticks[i] >> 32;
+                std::uint64_t ml = multiplier & 0xFFFFFFFFu, mh = multiplier >> 32;
+                std::uint64_t ll = tl * ml, lh = tl * mh, hl = th * ml, hh = th * mh;
+                std::uint64_t middle = (ll >> 32) + (lh & 0xFFFFFFFFu) + (hl & 0xFFFFFFFFu);
+                std::uint64_t low = (middle << 32) | (ll & 0xFFFFFFFFu);
+                std::uint64_t high = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+                nanoseconds[i] = static_cast<std::int64_t>(shift == 0 ? low : (low >> shift) | (high << (64 - shift)));
+#endif
+            }
+        }
+
+        template < unsigned Precision >
+        inline void CountBucketsScalar(const std::int64_t *values, std::size_t count, HistogramSnapshot<Precision> &snapshot)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+                snapshot.add(HistogramBuckets<Precision>::Index(values[i] > 0 ? static_cast<std::uint64_t>(values[i]) : 0), 1);
+        }
+
+#if defined(PROCESS_TIMING_SIMD_X86)
+
+        /**
+         *    @brief Convert 64 bits integers into doubles, over their whole range.
+         */
+        PROCESS_TIMING_TARGET_AVX2 inline __m256d Int64ToDoubleAvx2(__m256i x)
+        {
+            __m256i high = _mm256_srai_epi32(x, 16);
+            high = _mm256_blend_epi16(high, _mm256_setzero_si256(), 0x33);
+            high = _mm256_add_epi64(high, _mm256_castpd_si256(_mm256_set1_pd(442721857769029238784.0)));   // 3 * 2^67
+            __m256i low = _mm256_blend_epi16(x, _mm256_castpd_si256(_mm256_set1_pd(4503599627370496.0)), 0x88);    // 2^52
+            __m256d f = _mm256_sub_pd(_mm256_castsi256_pd(high), _mm256_set1_pd(442726361368656609280.0));   // 3 * 2^67 + 2^52
+            return _mm256_add_pd(f, _mm256_castsi256_pd(low));
+        }
+
+        PROCESS_TIMING_TARGET_AVX2 inline void StatisticsAvx2(const std::int64_t *values, std::size_t count, std::int64_t shift, StatisticsPartial &partial)
+        {
+            __m256i sum = _mm256_setzero_si256();
+            __m256i min = _mm256_set1_epi64x(partial.min);
+            __m256i max = _mm256_set1_epi64x(partial.max);
+            __m256i offset = _mm256_set1_epi64x(shift);
+            __m256d squares0 = _mm256_setzero_pd();
+            __m256d squares1 = _mm256_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 4));
+                min = _mm256_blendv_epi8(min, a, _mm256_cmpgt_epi64(min, a));
+                min = _mm256_blendv_epi8(min, b, _mm256_cmpgt_epi64(min, b));
+                max = _mm256_blendv_epi8(max, a, _mm256_cmpgt_epi64(a, max));
+                max = _mm256_blendv_epi8(max, b, _mm256_cmpgt_epi64(b, max));
+                a = _mm256_sub_epi64(a, offset);
+                b = _mm256_sub_epi64(b, offset);
+                sum = _mm256_add_epi64(sum, _mm256_add_epi64(a, b));
+                __m256d da = Int64ToDoubleAvx2(a);
+                __m256d db = Int64ToDoubleAvx2(b);
+                squares0 = _mm256_add_pd(squares0, _mm256_mul_pd(da, da));
+                squares1 = _mm256_add_pd(squares1, _mm256_mul_pd(db, db));
+            }
+            alignas(32) std::uint64_t sums[4];
+            alignas(32) std::int64_t mins[4], maxs[4];
+            alignas(32) double squares[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(mins), min);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), max);
+            _mm256_store_pd(squares, _mm256_add_pd(squares0, squares1));
+            for (int lane = 0; lane < 4; ++lane) {
+                partial.deviations += sums[lane];
+                partial.min = mins[lane] < partial.min ? mins[lane] : partial.min;
+                partial.max = maxs[lane] > partial.max ? maxs[lane] : partial.max;
+                partial.squares += squares[lane];
+            }
+            StatisticsScalar(values + i, count - i, shift, partial);
+        }
+
+        /**
+         *    @brief Convert ticks with a multiplier of shift 32: (t * m) >> 32 is th*mh << 32 + th*ml + tl*mh + (tl*ml >> 32).
+         */
+        PROCESS_TIMING_TARGET_AVX2 inline void TicksToNanosecondsAvx2(const std::uint64_t *ticks, std::int64_t *nanoseconds, std::size_t count, std::uint64_t multiplier)
+        {
+            const __m256i ml = _mm256_set1_epi64x(static_cast<long long>(multiplier & 0xFFFFFFFFu));
+            const __m256i mh = _mm256_set1_epi64x(static_cast<long long>(multiplier >> 32));
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m256i t = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ticks + i));
+                __m256i th = _mm256_srli_epi64(t, 32);
+                __m256i result = _mm256_slli_epi64(_mm256_mul_epu32(th, mh), 32);
+                result = _mm256_add_epi64(result, _mm256_mul_epu32(th, ml));
+                result = _mm256_add_epi64(result, _mm256_mul_epu32(t, mh));
+                result = _mm256_add_epi64(result, _mm256_srli_epi64(_mm256_mul_epu32(t, ml), 32));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(nanoseconds + i), result);
+            }
+            TicksToNanosecondsScalar(ticks + i, nanoseconds + i, count - i, multiplier, 32);
+        }
+
+        /**
+         *    @brief Compute the bucket indices of 4 values at once, as HistogramBuckets::Index() does, then count them.
+         *    AVX2 has no leading zero count, so the most significant bit is read from the exponent of the values converted
+         *    to doubles, less one where the conversion rounded up to the next power of two.
+         */
+        template < unsigned Precision >
+        PROCESS_TIMING_TARGET_AVX2 inline void CountBucketsAvx2(const std::int64_t *values, std::size_t count, HistogramSnapshot<Precision> &snapshot)
+        {
+            const __m256i one = _mm256_set1_epi64x(1);
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i bias = _mm256_set1_epi64x(1023 + static_cast<long long>(Precision));
+            alignas(32) std::uint64_t indices[4];
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+                value = _mm256_andnot_si256(_mm256_cmpgt_epi64(zero, value), value);
+                __m256i odd = _mm256_or_si256(value, one);
+                __m256i exponent = _mm256_srli_epi64(_mm256_castpd_si256(Int64ToDoubleAvx2(odd)), 52);
+                __m256i group = _mm256_sub_epi64(exponent, bias);
+                __m256i roundedUp = _mm256_cmpeq_epi64(_mm256_srlv_epi64(odd, _mm256_add_epi64(group, _mm256_set1_epi64x(Precision))), zero);
+                group = _mm256_add_epi64(group, roundedUp);
+                group = _mm256_andnot_si256(_mm256_cmpgt_epi64(zero, group), group);
+                __m256i index = _mm256_add_epi64(_mm256_slli_epi64(group, Precision), _mm256_srlv_epi64(value, group));
+                _mm256_store_si256(reinterpret_cast<__m256i*>(indices), index);
+                for (int lane = 0; lane < 4; ++lane)
+                    snapshot.add(static_cast<std::size_t>(indices[lane]), 1);
+            }
+            CountBucketsScalar(values + i, count - i, snapshot);
+        }
+
+#if defined(__GNUC__) && !defined(__clang__)
+    // The AVX-512 intrinsics of some GCC versions trigger false uninitialized warnings.
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+        PROCESS_TIMING_TARGET_AVX512 inline void StatisticsAvx512(const std::int64_t *values, std::size_t count, std::int64_t shift, StatisticsPartial &partial)
+        {
+            __m512i sum = _mm512_setzero_si512();
+            __m512i min = _mm512_set1_epi64(partial.min);
+            __m512i max = _mm512_set1_epi64(partial.max);
+            __m512i offset = _mm512_set1_epi64(shift);
+            __m512d squares0 = _mm512_setzero_pd();
+            __m512d squares1 = _mm512_setzero_pd();
+            std::size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                __m512i a = _mm512_loadu_si512(values + i);
+                __m512i b = _mm512_loadu_si512(values + i + 8);
+                min = _mm512_min_epi64(min, _mm512_min_epi64(a, b));
+                max = _mm512_max_epi64(max, _mm512_max_epi64(a, b));
+                a = _mm512_sub_epi64(a, offset);
+                b = _mm512_sub_epi64(b, offset);
+                sum = _mm512_add_epi64(sum, _mm512_add_epi64(a, b));
+                __m512d da = _mm512_cvtepi64_pd(a);
+                __m512d db = _mm512_cvtepi64_pd(b);
+                squares0 = _mm512_fmadd_pd(da, da, squares0);
+                squares1 = _mm512_fmadd_pd(db, db, squares1);
+            }
+            partial.deviations += static_cast<std::uint64_t>(_mm512_reduce_add_epi64(sum));
+            std::int64_t lanesMin = _mm512_reduce_min_epi64(min);
+            std::int64_t lanesMax = _mm512_reduce_max_epi64(max);
+            partial.min = lanesMin < partial.min ? lanesMin : partial.min;
+            partial.max = lanesMax > partial.max ? lanesMax : partial.max;
+            partial.squares += _mm512_reduce_add_pd(_mm512_add_pd(squares0, squares1));
+            StatisticsScalar(values + i, count - i, shift, partial);
+        }
+
+        PROCESS_TIMING_TARGET_AVX512 inline void TicksToNanosecondsAvx512(const std::uint64_t *ticks, std::int64_t *nanoseconds, std::size_t count, std::uint64_t multiplier)
+        {
+            const __m512i ml = _mm512_set1_epi64(static_cast<long long>(multiplier & 0xFFFFFFFFu));
+            const __m512i mh = _mm512_set1_epi64(static_cast<long long>(multiplier >> 32));
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m512i t = _mm512_loadu_si512(ticks + i);
+                __m512i th = _mm512_srli_epi64(t, 32);
+                __m512i result = _mm512_slli_epi64(_mm512_mul_epu32(th, mh), 32);
+                result = _mm512_add_epi64(result, _mm512_mul_epu32(th, ml));
+                result = _mm512_add_epi64(result, _mm512_mul_epu32(t, mh));
+                result = _mm512_add_epi64(result, _mm512_srli_epi64(_mm512_mul_epu32(t, ml), 32));
+                _mm512_storeu_si512(nanoseconds + i, result);
+            }
+            TicksToNanosecondsScalar(ticks + i, nanoseconds + i, count - i, multiplier, 32);
+        }
+
+        /**
+         *    @brief Compute the bucket indices of 8 values at once, as HistogramBuckets::Index() does, then count them.
+         */
+        template < unsigned Precision >
+        PROCESS_TIMING_TARGET_AVX512 inline void CountBucketsAvx512(const std::int64_t *values, std::size_t count, HistogramSnapshot<Precision> &snapshot)
+        {
+            const __m512i one = _mm512_set1_epi64(1);
+            const __m512i zero = _mm512_setzero_si512();
+            const __m512i base = _mm512_set1_epi64(63 - static_cast<long long>(Precision));
+            alignas(64) std::uint64_t indices[8];
+            std::size_t i = 0;
+            for (; i + 8 <= count; i += 8) {
+                __m512i value = _mm512_max_epi64(_mm512_loadu_si512(values + i), zero);
+                __m512i group = _mm512_max_epi64(_mm512_sub_epi64(base, _mm512_lzcnt_epi64(_mm512_or_si512(value, one))), zero);
+                __m512i index = _mm512_add_epi64(_mm512_slli_epi64(group, Precision), _mm512_srlv_epi64(value, group));
+                _mm512_store_si512(indices, index);
+                for (int lane = 0; lane < 8; ++lane)
+                    snapshot.add(static_cast<std::size_t>(indices[lane]), 1);
+            }
+            CountBucketsScalar(values + i, count - i, snapshot);
+        }
+
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+
+#elif defined(PROCESS_TIMING_SIMD_NEON)
+
+        inline void StatisticsNeon(const std::int64_t *values, std::size_t count, std::int64_t shift, StatisticsPartial &partial)
+        {
+            int64x2_t sum = vdupq_n_s64(0);
+            int64x2_t min = vdupq_n_s64(partial.min);
+            int64x2_t max = vdupq_n_s64(partial.max);
+            int64x2_t offset = vdupq_n_s64(shift);
+            float64x2_t squares0 = vdupq_n_f64(0.0);
+            float64x2_t squares1 = vdupq_n_f64(0.0);
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                int64x2_t a = vld1q_s64(values + i);
+                int64x2_t b = vld1q_s64(values + i + 2);
+                min = vbslq_s64(vcgtq_s64(min, a), a, min);
+                min = vbslq_s64(vcgtq_s64(min, b), b, min);
+                max = vbslq_s64(vcgtq_s64(a, max), a, max);
+                max = vbslq_s64(vcgtq_s64(b, max), b, max);
+                a = vsubq_s64(a, offset);
+                b = vsubq_s64(b, offset);
+                sum = vaddq_s64(sum, vaddq_s64(a, b));
+                float64x2_t da = vcvtq_f64_s64(a);
+                float64x2_t db = vcvtq_f64_s64(b);
+                squares0 = vfmaq_f64(squares0, da, da);
+                squares1 = vfmaq_f64(squares1, db, db);
+            }
+            uint64x2_t sums = vreinterpretq_u64_s64(sum);
+            partial.deviations += vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1);
+            for (std::int64_t lane : { vgetq_lane_s64(min, 0), vgetq_lane_s64(min, 1) })
+                partial.min = lane < partial.min ? lane : partial.min;
+            for (std::int64_t lane : { vgetq_lane_s64(max, 0), vgetq_lane_s64(max, 1) })
+                partial.max = lane > partial.max ? lane : partial.max;
+            partial.squares += vaddvq_f64(vaddq_f64(squares0, squares1));
+            StatisticsScalar(values + i, count - i, shift, partial);
+        }
+
+        inline void TicksToNanosecondsNeon(const std::uint64_t *ticks, std::int64_t *nanoseconds, std::size_t count, std::uint64_t multiplier)
+        {
+            const uint32x2_t ml = vdup_n_u32(static_cast<std::uint32_t>(multiplier));
+            const uint32x2_t mh = vdup_n_u32(static_cast<std::uint32_t>(multiplier >> 32));
+            std::size_t i = 0;
+            for (; i + 2 <= count; i += 2) {
+                uint64x2_t t = vld1q_u64(ticks + i);
+                uint32x2_t tl = vmovn_u64(t);
+                uint32x2_t th = vshrn_n_u64(t, 32);
+                uint64x2_t result = vshlq_n_u64(vmull_u32(th, mh), 32);
+                result = vaddq_u64(result, vmull_u32(th, ml));
+                result = vaddq_u64(result, vmull_u32(tl, mh));
+                result = vaddq_u64(result, vshrq_n_u64(vmull_u32(tl, ml), 32));
+                vst1q_s64(nanoseconds + i, vreinterpretq_s64_u64(result));
+            }
+            TicksToNanosecondsScalar(ticks + i, nanoseconds + i, count - i, multiplier, 32);
+        }
+
+#endif
+
+        inline SimdLevel DetectSimdLevel()
+        {
+#if defined(PROCESS_TIMING_SIMD_X86)
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512cd"))
+                return SimdLevel::Avx512;
+            if (__builtin_cpu_supports("avx2"))
+                return SimdLevel::Avx2;
+            return SimdLevel::Scalar;
+#elif defined(PROCESS_TIMING_SIMD_NEON)
+            return SimdLevel::Neon;
+#else
+            return SimdLevel::Scalar;
+#endif
+        }
+
+    }
+
+
+
+    /**
+     *    @brief Return the best instruction set supported by both the build and the running CPU, detected once.
+     */
+    inline SimdLevel SupportedSimdLevel()
+    {
+        static const SimdLevel level = detail::DetectSimdLevel();
+        return level;
+    }
+
+    /**
+     *    @brief Compute the count, sum, minimum, maximum, mean and variance of an array of values, e.g. tick counts or
+     *    nanosecond durations. Values are accumulated as deviations from the first one, so mean and variance stay exact
+     *    while count times the largest deviation is below 2^63, however large the values; the sum saturates.
+     *    @param level The instruction set to use; it must not be beyond SupportedSimdLevel().
+     */
+    inline BatchStatistics ComputeStatistics(const std::int64_t *values, std::size_t count, SimdLevel level = SupportedSimdLevel())
+    {
+        BatchStatistics statistics = { count, 0, 0, 0, 0.0, 0.0 };
+        if (count == 0)
+            return statistics;
+
+        // Squares are summed around the first value, keeping them small and the variance accurate.
+        const std::int64_t shift = values[0];
+        detail::StatisticsPartial partial = { 0, std::numeric_limits<std::int64_t>::max(), std::numeric_limits<std::int64_t>::min(), 0.0 };
+        switch (level) {
+#if defined(PROCESS_TIMING_SIMD_X86)
+            case SimdLevel::Avx512: detail::StatisticsAvx512(values, count, shift, partial); break;
+            case SimdLevel::Avx2:   detail::StatisticsAvx2(values, count, shift, partial); break;
+#elif defined(PROCESS_TIMING_SIMD_NEON)
+            case SimdLevel::Neon:   detail::StatisticsNeon(values, count, shift, partial); break;
+#endif
+            default:                detail::StatisticsScalar(values, count, shift, partial); break;
+        }
+
+        const double n = static_cast<double>(count);
+        const double deviations = static_cast<double>(static_cast<std::int64_t>(partial.deviations));
+        const long double sum = static_cast<long double>(shift) * static_cast<long double>(count) + static_cast<long double>(deviations);
+        if (sum >= static_cast<long double>(std::numeric_limits<std::int64_t>::max()))
+            statistics.sum = std::numeric_limits<std::int64_t>::max();
+        else if (sum <= static_cast<long double>(std::numeric_limits<std::int64_t>::min()))
+            statistics.sum = std::numeric_limits<std::int64_t>::min();
+        else
+            statistics.sum = static_cast<std::int64_t>(static_cast<std::uint64_t>(shift) * count + partial.deviations);
+        statistics.min = partial.min;
+        statistics.max = partial.max;
+        statistics.mean = static_cast<double>(shift) + deviations / n;
+        statistics.variance = (partial.squares - deviations * deviations / n) / n;
+        if (statistics.variance < 0.0)
+            statistics.variance = 0.0;
+        return statistics;
+    }
+
+    /**
+     *    @brief Add an array of nanosecond values to the buckets of a histogram snapshot; negative values count as zero.
+     *    Only the x86 levels have vector kernels: NEON has no 64 bits leading zero count, so it runs the scalar code.
+     *    @param level The instruction set to use; it must not be beyond SupportedSimdLevel().
+     */
+    template < unsigned Precision >
+    inline void CountBuckets(const std::int64_t *values, std::size_t count, HistogramSnapshot<Precision> &snapshot,
+                             SimdLevel level = SupportedSimdLevel())
+    {
+#if defined(PROCESS_TIMING_SIMD_X86)
+        if (level == SimdLevel::Avx512) {
+            detail::CountBucketsAvx512(values, count, snapshot);
+            return;
+        }
+        if (level == SimdLevel::Avx2) {
+            detail::CountBucketsAvx2(values, count, snapshot);
+            return;
+        }
+#endif
+        static_cast<void>(level);
+        detail::CountBucketsScalar(values, count, snapshot);
+    }
+
+    /**
+     *    @brief Convert an array of raw counter ticks into nanoseconds: ns = (ticks * multiplier) >> shift.
+     *    Vector kernels are used for the shift of 32 bits of the TSC clock calibration.
+     *    @param level The instruction set to use; it must not be beyond SupportedSimdLevel().
+     */
+    inline void TicksToNanoseconds(const std::uint64_t *ticks, std::int64_t *nanoseconds, std::size_t count,
+                                   std::uint64_t multiplier, unsigned shift, SimdLevel level = SupportedSimdLevel())
+    {
+        if (shift == 32) {
+            switch (level) {
+#if defined(PROCESS_TIMING_SIMD_X86)
+                case SimdLevel::Avx512: detail::TicksToNanosecondsAvx512(ticks, nanoseconds, count, multiplier); return;
+                case SimdLevel::Avx2:   detail::TicksToNanosecondsAvx2(ticks, nanoseconds, count, multiplier); return;
+#elif defined(PROCESS_TIMING_SIMD_NEON)
+                case SimdLevel::Neon:   detail::TicksToNanosecondsNeon(ticks, nanoseconds, count, multiplier); return;
+#endif
+                default:                break;
+            }
+        }
+        detail::TicksToNanosecondsScalar(ticks, nanoseconds, count, multiplier, shift);
+    }
+
+#ifdef PROCESS_TIMING_HAS_TSC_CLOCK
+
+    /**
+     *    @brief Convert an array of TSC clock ticks into nanoseconds, with the clock calibration.
+     */
+    inline void TicksToNanoseconds(const std::uint64_t *ticks, std::int64_t *nanoseconds, std::size_t count,
+                                   const TscClock::Calibration &calibration = TscClock::calibration(), SimdLevel level = SupportedSimdLevel())
+    {
+        TicksToNanoseconds(ticks, nanoseconds, count, calibration.multiplier, calibration.shift, level);
+    }
+
+#endif
+
+}
+
+#endif // process_timing_batch_statistics_hpp
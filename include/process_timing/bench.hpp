@@ -0,0 +1,665 @@
+#ifndef process_timing_bench_hpp
+#define process_timing_bench_hpp
+
+#include "process_timing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <ostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+namespace timings {
+
+    namespace bench {
+
+        /**
+         *    @brief Prevent the compiler from optimizing away the computation of a value.
+         */
+        template < class T >
+        inline void DoNotOptimize(const T &value)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : "r,m"(value) : "memory");
+#else
+            static_cast<void>(*static_cast<const volatile char *>(static_cast<const volatile void *>(&value)));
+            _ReadWriteBarrier();
+#endif
+        }
+
+        template < class T >
+        inline void DoNotOptimize(T &value)
+        {
+#if defined(__clang__)
+            asm volatile("" : "+r,m"(value) : : "memory");
+#elif defined(__GNUC__)
+            asm volatile("" : "+m,r"(value) : : "memory");
+#else
+            static_cast<void>(*static_cast<volatile char *>(static_cast<volatile void *>(&value)));
+            _ReadWriteBarrier();
+#endif
+        }
+
+        /**
+         *    @brief Prevent the compiler from caching memory contents across this point.
+         */
+        inline void ClobberMemory()
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : : "memory");
+#else
+            _ReadWriteBarrier();
+#endif
+        }
+
+
+
+        /**
+         *    @brief The Options struct configures how a benchmark is run.
+         */
+        struct Options {
+            std::chrono::nanoseconds    warmupTime  = std::chrono::milliseconds(100);   ///< How long the function runs before measuring.
+            std::chrono::nanoseconds    sampleTime  = std::chrono::milliseconds(10);    ///< The minimum duration of a sample.
+            std::size_t                 samples     = 30;                               ///< The number of samples.
+        };
+
+
+
+        /**
+         *    @brief The Result struct holds the statistics of a benchmark, per iteration of the function.
+         */
+        struct Result {
+            std::string             name;       ///< The benchmark name.
+            std::uint64_t           iterations; ///< The number of iterations of each sample.
+            double                  overhead;   ///< The clock overhead subtracted from each sample, in nanoseconds.
+            std::vector<double>     samples;    ///< The time per iteration of each sample, in nanoseconds.
+            double                  mean;       ///< The mean of the samples, in nanoseconds.
+            double                  median;     ///< The median of the samples, in nanoseconds.
+            double                  mad;        ///< The median absolute deviation of the samples, in nanoseconds.
+            double                  min;        ///< The smallest sample, in nanoseconds.
+            double                  max;        ///< The largest sample, in nanoseconds.
+        };
+
+
+
+        namespace detail {
+
+            inline double Median(std::vector<double> values)
+            {
+                if (values.empty())
+                    return 0.0;
+                std::size_t middle = values.size() / 2;
+                std::nth_element(values.begin(), values.begin() + middle, values.end());
+                double median = values[middle];
+                if (values.size() % 2 == 0)
+                    median = 0.5 * (median + *std::max_element(values.begin(), values.begin() + middle));
+                return median;
+            }
+
+            /**
+             *    @brief Run fn for the given number of iterations and return the elapsed time, in nanoseconds.
+             */
+            template < class Clock, class Function >
+            inline double TimeBatch(Function &fn, std::uint64_t iterations)
+            {
+                BasicProcessTiming<Clock, ThreadingPolicy::Single> timing;
+                for (std::uint64_t i = 0; i < iterations; ++i) {
+                    fn();
+                    ClobberMemory();
+                }
+                timing.stop();
+                return std::chrono::duration<double,std::nano>(timing.elapsed()).count();
+            }
+
+            /**
+             *    @brief Return the minimum time, in nanoseconds, measured by a start()/stop() pair around no work.
+             */
+            template < class Clock >
+            inline double ClockOverhead()
+            {
+                double overhead = 0.0;
+                for (int i = 0; i < 1000; ++i) {
+                    BasicProcessTiming<Clock, ThreadingPolicy::Single> timing;
+                    timing.stop();
+                    double elapsed = std::chrono::duration<double,std::nano>(timing.elapsed()).count();
+                    if (i == 0 || elapsed < overhead)
+                        overhead = elapsed;
+                }
+                return overhead;
+            }
+
+            inline void WriteJsonString(std::ostream &out, const std::string &str)
+            {
+                out << '"';
+                for (char c : str) {
+                    if (c == '"' || c == '\\')
+                        out << '\\' << c;
+                    else if (static_cast<unsigned char>(c) < 0x20)
+                        out << ' ';
+                    else
+                        out << c;
+                }
+                out << '"';
+            }
+
+        }
+
+
+
+        /**
+         *    @brief Compute the statistics of a result from its samples.
+         */
+        inline void Summarize(Result &result)
+        {
+            result.mean = 0.0;
+            for (double sample : result.samples)
+                result.mean += sample;
+            result.mean /= result.samples.empty() ? 1.0 : static_cast<double>(result.samples.size());
+            result.median = detail::Median(result.samples);
+            std::vector<double> deviations;
+            deviations.reserve(result.samples.size());
+            for (double sample : result.samples)
+                deviations.push_back(std::fabs(sample - result.median));
+            result.mad = detail::Median(deviations);
+            result.min = result.samples.empty() ? 0.0 : *std::min_element(result.samples.begin(), result.samples.end());
+            result.max = result.samples.empty() ? 0.0 : *std::max_element(result.samples.begin(), result.samples.end());
+        }
+
+
+
+        /**
+         *    @brief Benchmark a function: run it for the warmup time, double its iteration count until a batch lasts at least
+         *    the sample time, then time the given number of samples, subtracting the clock overhead from each.
+         *    @param name The benchmark name.
+         *    @param fn The function to benchmark, called with no arguments; use DoNotOptimize() on its results.
+         */
+        template < class Clock = std::chrono::steady_clock, class Function >
+        Result run(const std::string &name, Function &&fn, const Options &options = Options())
+        {
+            const double warmupTime = std::chrono::duration<double,std::nano>(options.warmupTime).count();
+            const double sampleTime = std::chrono::duration<double,std::nano>(options.sampleTime).count();
+
+            Result result;
+            result.name = name;
+            result.overhead = detail::ClockOverhead<Clock>();
+
+            std::uint64_t iterations = 1;
+            double warmedUp = 0.0;
+            while (warmedUp < warmupTime) {
+                warmedUp += detail::TimeBatch<Clock>(fn, iterations);
+                iterations *= 2;
+            }
+            for (iterations = 1; ; iterations *= 2) {
+                double elapsed = detail::TimeBatch<Clock>(fn, iterations);
+                if (elapsed >= sampleTime) {
+                    if (elapsed > 0.0)
+                        iterations = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(static_cast<double>(iterations) * sampleTime / elapsed));
+                    break;
+                }
+            }
+            result.iterations = iterations;
+
+            result.samples.reserve(options.samples);
+            for (std::size_t s = 0; s < options.samples; ++s) {
+                double elapsed = detail::TimeBatch<Clock>(fn, iterations) - result.overhead;
+                result.samples.push_back(std::max(0.0, elapsed) / static_cast<double>(iterations));
+            }
+
+            Summarize(result);
+            return result;
+        }
+
+
+
+        /**
+         *    @brief The Runner class runs the benchmarks of an executable, selected and configured from its command line,
+         *    prints their results as a table and optionally writes them as JSON.
+         *
+         *    Command line: [--filter=<substring>] [--json=<file>] [--samples=<n>] [--sample-ms=<ms>] [--warmup-ms=<ms>]
+         */
+        class Runner {
+        public:
+            Runner(int argc, char **argv, std::ostream &out = std::cout) : _out(out), _headerPrinted(false)
+            {
+                for (int i = 1; i < argc; ++i) {
+                    std::string arg(argv[i]);
+                    if (Option(arg, "--filter=", _filter)) {
+                    } else if (Option(arg, "--json=", _jsonPath)) {
+                    } else if (arg.compare(0, 10, "--samples=") == 0) {
+                        _options.samples = static_cast<std::size_t>(std::strtoul(arg.c_str() + 10, nullptr, 10));
+                    } else if (arg.compare(0, 12, "--sample-ms=") == 0) {
+                        _options.sampleTime = std::chrono::milliseconds(std::strtoul(arg.c_str() + 12, nullptr, 10));
+                    } else if (arg.compare(0, 12, "--warmup-ms=") == 0) {
+                        _options.warmupTime = std::chrono::milliseconds(std::strtoul(arg.c_str() + 12, nullptr, 10));
+                    } else {
+                        std::cerr << "unknown argument: " << arg << '\n';
+                    }
+                }
+            }
+
+            Runner(const Runner &) = delete;
+            Runner &operator=(const Runner &) = delete;
+
+            /**
+             *    @brief Write the JSON results, if requested.
+             */
+            ~Runner()
+            {
+                if (!_jsonPath.empty()) {
+                    std::ofstream json(_jsonPath.c_str());
+                    writeJson(json);
+                }
+            }
+
+            /**
+             *    @brief Run a benchmark, if selected by the filter, and print its result.
+             */
+            template < class Clock = std::chrono::steady_clock, class Function >
+            void run(const std::string &name, Function &&fn)
+            {
+                if (!selected(name))
+                    return;
+                add(bench::run<Clock>(name, std::forward<Function>(fn), _options));
+            }
+
+            /**
+             *    @brief Tell if a benchmark is selected by the filter.
+             */
+            inline bool selected(const std::string &name) const
+            {
+                return _filter.empty() || name.find(_filter) != std::string::npos;
+            }
+
+            /**
+             *    @brief Add and print a result measured elsewhere.
+             */
+            void add(const Result &result)
+            {
+                if (!_headerPrinted) {
+                    _headerPrinted = true;
+                    Print(_out, "benchmark", "iterations", "mean", "median", "mad", "min");
+                }
+                char numbers[4][32];
+                std::snprintf(numbers[0], sizeof(numbers[0]), "%.2f ns", result.mean);
+                std::snprintf(numbers[1], sizeof(numbers[1]), "%.2f ns", result.median);
+                std::snprintf(numbers[2], sizeof(numbers[2]), "%.2f ns", result.mad);
+                std::snprintf(numbers[3], sizeof(numbers[3]), "%.2f ns", result.min);
+                Print(_out, result.name, std::to_string(result.iterations), numbers[0], numbers[1], numbers[2], numbers[3]);
+                _results.push_back(result);
+            }
+
+            /**
+             *    @brief Return the options the benchmarks are run with.
+             */
+            inline const Options &options() const
+            {
+                return _options;
+            }
+
+            /**
+             *    @brief Return the results of the benchmarks run so far.
+             */
+            inline const std::vector<Result> &results() const
+            {
+                return _results;
+            }
+
+            /**
+             *    @brief Write the results as a JSON document: {"benchmarks": [{"name", "iterations", "overhead_ns",
+             *    "mean_ns", "median_ns", "mad_ns", "min_ns", "max_ns", "samples_ns": [...]}, ...]}.
+             */
+            void writeJson(std::ostream &out) const
+            {
+                out.precision(17);
+                out << "{\n  \"benchmarks\": [";
+                for (std::size_t r = 0; r < _results.size(); ++r) {
+                    const Result &result = _results[r];
+                    out << (r == 0 ? "\n" : ",\n") << "    {\"name\": ";
+                    detail::WriteJsonString(out, result.name);
+                    out << ", \"iterations\": " << result.iterations
+                        << ", \"overhead_ns\": " << result.overhead
+                        << ", \"mean_ns\": " << result.mean
+                        << ", \"median_ns\": " << result.median
+                        << ", \"mad_ns\": " << result.mad
+                        << ", \"min_ns\": " << result.min
+                        << ", \"max_ns\": " << result.max
+                        << ", \"samples_ns\": [";
+                    for (std::size_t s = 0; s < result.samples.size(); ++s)
+                        out << (s == 0 ? "" : ", ") << result.samples[s];
+                    out << "]}";
+                }
+                out << "\n  ]\n}\n";
+            }
+
+        private:
+            static bool Option(const std::string &arg, const char *prefix, std::string &value)
+            {
+                std::size_t length = std::strlen(prefix);
+                if (arg.compare(0, length, prefix) != 0)
+                    return false;
+                value = arg.substr(length);
+                return true;
+            }
+
+            static void Print(std::ostream &out, const std::string &name, const std::string &iterations, const std::string &mean,
+                              const std::string &median, const std::string &mad, const std::string &min)
+            {
+                char line[256];
+                std::snprintf(line, sizeof(line), "%-40s %12s %14s %14s %12s %14s\n", name.c_str(), iterations.c_str(), mean.c_str(),
+                              median.c_str(), mad.c_str(), min.c_str());
+                out << line;
+            }
+
+            std::ostream           &_out;           ///< The stream the results are printed to.
+            bool                    _headerPrinted; ///< Tells if the table header has been printed.
+            Options                 _options;       ///< The options the benchmarks are run with.
+            std::string             _filter;        ///< Only benchmarks whose name contains it are run.
+            std::string             _jsonPath;      ///< The file the JSON results are written to, if not empty.
+            std::vector<Result>     _results;       ///< The results of the benchmarks run so far.
+        };
+
+
+
+        namespace detail {
+
+            /**
+             *    @brief The JsonReader class parses the JSON documents written by Runner::writeJson(), skipping unknown members.
+             */
+            class JsonReader {
+            public:
+                explicit JsonReader(const std::string &text) : _position(text.data()), _end(text.data() + text.size()) { }
+
+                bool readResults(std::vector<Result> &results)
+                {
+                    if (!expect('{'))
+                        return false;
+                    std::string key;
+                    while (member(key)) {
+                        if (key == "benchmarks") {
+                            if (!expect('['))
+                                return false;
+                            while (!expect(']')) {
+                                Result result = Result();
+                                if (!readResult(result) || (!expect(',') && peek() != ']'))
+                                    return false;
+                                Summarize(result);
+                                results.push_back(std::move(result));
+                            }
+                        } else if (!skipValue()) {
+                            return false;
+                        }
+                        if (!expect(',') && peek() != '}')
+                            return false;
+                    }
+                    return expect('}');
+                }
+
+            private:
+                bool readResult(Result &result)
+                {
+                    if (!expect('{'))
+                        return false;
+                    std::string key;
+                    while (member(key)) {
+                        double number = 0.0;
+                        if (key == "name") {
+                            if (!string(result.name))
+                                return false;
+                        } else if (key == "iterations" || key == "overhead_ns") {
+                            if (!this->number(number))
+                                return false;
+                            if (key == "iterations")
+                                result.iterations = static_cast<std::uint64_t>(number);
+                            else
+                                result.overhead = number;
+                        } else if (key == "samples_ns") {
+                            if (!expect('['))
+                                return false;
+                            while (!expect(']')) {
+                                if (!this->number(number) || (!expect(',') && peek() != ']'))
+                                    return false;
+                                result.samples.push_back(number);
+                            }
+                        } else if (!skipValue()) {
+                            return false;
+                        }
+                        if (!expect(',') && peek() != '}')
+                            return false;
+                    }
+                    return expect('}');
+                }
+
+                /**
+                 *    @brief Read the key of the next member of an object, if any, up to its colon.
+                 */
+                bool member(std::string &key)
+                {
+                    return peek() == '"' && string(key) && expect(':');
+                }
+
+                char peek()
+                {
+                    while (_position != _end && (*_position == ' ' || *_position == '\n' || *_position == '\r' || *_position == '\t'))
+                        ++_position;
+                    return _position != _end ? *_position : '\0';
+                }
+
+                bool expect(char c)
+                {
+                    if (peek() != c)
+                        return false;
+                    ++_position;
+                    return true;
+                }
+
+                bool string(std::string &value)
+                {
+                    if (!expect('"'))
+                        return false;
+                    value.clear();
+                    while (_position != _end && *_position != '"') {
+                        char c = *_position++;
+                        if (c == '\\') {
+                            if (_position == _end)
+                                return false;
+                            c = *_position++;
+                            if (c == 'u') {
+                                if (_end - _position < 4)
+                                    return false;
+                                _position += 4;
+                                c = '?';
+                            } else if (c == 'n' || c == 't' || c == 'r' || c == 'b' || c == 'f') {
+                                c = ' ';
+                            }
+                        }
+                        value.push_back(c);
+                    }
+                    return expect('"');
+                }
+
+                bool number(double &value)
+                {
+                    peek();
+                    char *end = nullptr;
+                    value = std::strtod(_position, &end);
+                    if (end == _position || end > _end)
+                        return false;
+                    _position = end;
+                    return true;
+                }
+
+                bool skipValue()
+                {
+                    char c = peek();
+                    std::string text;
+                    double number = 0.0;
+                    if (c == '"')
+                        return string(text);
+                    if (c == '{' || c == '[') {
+                        char close = c == '{' ? '}' : ']';
+                        ++_position;
+                        while (!expect(close)) {
+                            if ((c == '{' && !member(text)) || !skipValue() || (!expect(',') && peek() != close))
+                                return false;
+                        }
+                        return true;
+                    }
+                    for (const char *literal : { "true", "false", "null" }) {
+                        std::size_t length = std::strlen(literal);
+                        if (static_cast<std::size_t>(_end - _position) >= length && std::strncmp(_position, literal, length) == 0) {
+                            _position += length;
+                            return true;
+                        }
+                    }
+                    return this->number(number);
+                }
+
+                const char *_position;  ///< The next character to parse.
+                const char *_end;       ///< The end of the document.
+            };
+
+            /**
+             *    @brief Return the one-sided p-value of the Mann-Whitney U test that the samples of b tend to be larger than
+             *    the ones of a, with the normal approximation corrected for ties and continuity.
+             */
+            inline double MannWhitneyGreater(const std::vector<double> &a, const std::vector<double> &b)
+            {
+                std::vector<std::pair<double, bool>> all;
+                all.reserve(a.size() + b.size());
+                for (double value : a)
+                    all.emplace_back(value, false);
+                for (double value : b)
+                    all.emplace_back(value, true);
+                std::sort(all.begin(), all.end(), [](const std::pair<double, bool> &x, const std::pair<double, bool> &y) { return x.first < y.first; });
+
+                double n1 = static_cast<double>(a.size()), n2 = static_cast<double>(b.size()), n = n1 + n2;
+                double ranks = 0.0, ties = 0.0;
+                for (std::size_t i = 0; i < all.size(); ) {
+                    std::size_t j = i;
+                    while (j < all.size() && all[j].first == all[i].first)
+                        ++j;
+                    double rank = 0.5 * static_cast<double>(i + j + 1);
+                    double t = static_cast<double>(j - i);
+                    ties += t * t * t - t;
+                    for (; i < j; ++i)
+                        if (all[i].second)
+                            ranks += rank;
+                }
+                double u = ranks - n2 * (n2 + 1.0) / 2.0;
+                double variance = n1 * n2 / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0)));
+                if (n1 == 0.0 || n2 == 0.0 || variance <= 0.0)
+                    return 1.0;
+                double z = (u - n1 * n2 / 2.0 - 0.5) / std::sqrt(variance);
+                return 0.5 * std::erfc(z / std::sqrt(2.0));
+            }
+
+        }
+
+
+
+        /**
+         *    @brief Read the results of a JSON document written by Runner::writeJson(), recomputing their statistics from
+         *    their samples.
+         *    @return false if the document is malformed.
+         */
+        inline bool ReadJson(std::istream &in, std::vector<Result> &results)
+        {
+            std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            return detail::JsonReader(text).readResults(results);
+        }
+
+
+
+        /**
+         *    @brief The CompareOptions struct configures how the results of two runs are compared.
+         */
+        struct CompareOptions {
+            double          alpha       = 0.01;     ///< The significance level of the tests; the confidence intervals are at 1 - 2 alpha.
+            double          threshold   = 0.05;     ///< The relative slowdown of the median a regression must exceed.
+            std::size_t     resamples   = 2000;     ///< The number of bootstrap resamples.
+            std::uint64_t   seed        = 1;        ///< The seed of the bootstrap, fixed so that comparisons are reproducible.
+        };
+
+
+
+        /**
+         *    @brief The Comparison struct holds the change of a benchmark between a baseline and a candidate run.
+         */
+        struct Comparison {
+            std::string     name;        ///< The benchmark name.
+            double          baseline;    ///< The median of the baseline samples, in nanoseconds.
+            double          candidate;   ///< The median of the candidate samples, in nanoseconds.
+            double          change;      ///< The relative change of the median, e.g. 0.1 for 10% slower.
+            double          lower;       ///< The lower bound of the bootstrap confidence interval of the change.
+            double          upper;       ///< The upper bound of the bootstrap confidence interval of the change.
+            double          slower;      ///< The p-value of the candidate being slower, from the Mann-Whitney U test.
+            double          faster;      ///< The p-value of the candidate being faster, from the Mann-Whitney U test.
+            bool            regression;  ///< Tells if the candidate is significantly slower by more than the threshold.
+            bool            improvement; ///< Tells if the candidate is significantly faster by more than the threshold.
+        };
+
+
+
+        /**
+         *    @brief Compare the samples of a benchmark in two runs, with a Mann-Whitney U test and a bootstrap confidence
+         *    interval of the relative change of the median. A regression is reported only if the candidate is significantly
+         *    slower and the whole interval lies above the threshold, so that noisy benchmarks do not flap.
+         */
+        inline Comparison Compare(const Result &baseline, const Result &candidate, const CompareOptions &options = CompareOptions())
+        {
+            Comparison comparison;
+            comparison.name = candidate.name;
+            comparison.baseline = detail::Median(baseline.samples);
+            comparison.candidate = detail::Median(candidate.samples);
+            comparison.change = comparison.baseline > 0.0 ? comparison.candidate / comparison.baseline - 1.0 : 0.0;
+            comparison.slower = detail::MannWhitneyGreater(baseline.samples, candidate.samples);
+            comparison.faster = detail::MannWhitneyGreater(candidate.samples, baseline.samples);
+            comparison.lower = comparison.upper = comparison.change;
+
+            if (!baseline.samples.empty() && !candidate.samples.empty() && options.resamples > 0) {
+                std::mt19937_64 random(options.seed);
+                std::vector<double> changes, a(baseline.samples.size()), b(candidate.samples.size());
+                changes.reserve(options.resamples);
+                std::uniform_int_distribution<std::size_t> pickA(0, a.size() - 1), pickB(0, b.size() - 1);
+                for (std::size_t r = 0; r < options.resamples; ++r) {
+                    for (double &value : a)
+                        value = baseline.samples[pickA(random)];
+                    for (double &value : b)
+                        value = candidate.samples[pickB(random)];
+                    double median = detail::Median(a);
+                    if (median > 0.0)
+                        changes.push_back(detail::Median(b) / median - 1.0);
+                }
+                if (!changes.empty()) {
+                    std::sort(changes.begin(), changes.end());
+                    double last = static_cast<double>(changes.size() - 1);
+                    comparison.lower = changes[static_cast<std::size_t>(std::floor(options.alpha * last))];
+                    comparison.upper = changes[static_cast<std::size_t>(std::ceil((1.0 - options.alpha) * last))];
+                }
+            }
+
+            comparison.regression = comparison.slower < options.alpha && comparison.lower > options.threshold;
+            comparison.improvement = comparison.faster < options.alpha && comparison.upper < -options.threshold;
+            return comparison;
+        }
+
+    }
+
+}
+
+#endif // process_timing_bench_hpp
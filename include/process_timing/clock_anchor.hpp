@@ -0,0 +1,150 @@
+#ifndef process_timing_clock_anchor_hpp
+#define process_timing_clock_anchor_hpp
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace timings {
+
+    /**
+     *    @brief The ClockAnchor struct pairs a tick of a local clock, e.g. std::chrono::steady_clock, whose epoch is
+     *    arbitrary, with the time of a wall clock shared by the hosts, e.g. std::chrono::system_clock disciplined by NTP
+     *    or PTP, taken at the same instant, so that ticks of different hosts can be placed on a common timeline.
+     */
+    struct ClockAnchor {
+        std::int64_t    ticks;          ///< The local clock ticks from its epoch.
+        std::int64_t    wall;           ///< The wall clock nanoseconds from its epoch, e.g. the Unix epoch.
+        std::int64_t    uncertainty;    ///< Half the time between the local clock reads around the wall clock read, in nanoseconds.
+    };
+
+
+
+    /**
+     *    @brief Take a clock anchor: the wall clock is read between two local clock reads, whose midpoint is paired with
+     *    it; the tightest of a few attempts is kept, so that a preemption between the reads does not spoil the anchor.
+     *    @param attempts The number of attempts; zero is taken as one.
+     */
+    template < class Clock = std::chrono::steady_clock, class WallClock = std::chrono::system_clock >
+    ClockAnchor TakeClockAnchor(unsigned attempts = 5)
+    {
+        ClockAnchor anchor = { 0, 0, 0 };
+        typename Clock::duration best = Clock::duration::max();
+        for (unsigned attempt = 0; attempt < attempts || attempt == 0; ++attempt) {
+            typename Clock::time_point before = Clock::now();
+            typename WallClock::time_point wall = WallClock::now();
+            typename Clock::time_point after = Clock::now();
+            if (after - before < best) {
+                best = after - before;
+                anchor.ticks = static_cast<std::int64_t>((before + (after - before) / 2).time_since_epoch().count());
+                anchor.wall = static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(wall.time_since_epoch()).count());
+                anchor.uncertainty = static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(best).count() / 2);
+            }
+        }
+        return anchor;
+    }
+
+
+
+    /**
+     *    @brief The ClockTimeline class maps the ticks of a local clock onto the timeline of the wall clock of its anchors,
+     *    correcting the drift of the local clock: between two anchors, ticks are interpolated linearly; before the first
+     *    and after the last, the rate of the nearest pair of anchors is extrapolated.
+     *
+     *    With a single anchor, or between anchors whose wall times do not increase, e.g. because the wall clock was
+     *    stepped, the nominal tick period is used. Without anchors, the ticks are only converted to nanoseconds.
+     */
+    class ClockTimeline {
+    public:
+        /**
+         *    @param anchors The anchors of the local clock, in any order.
+         *    @param periodNum The tick period numerator, in seconds.
+         *    @param periodDen The tick period denominator, in seconds.
+         */
+        explicit ClockTimeline(std::vector<ClockAnchor> anchors = std::vector<ClockAnchor>(), std::int64_t periodNum = 1, std::int64_t periodDen = 1000000000)
+            : _anchors(std::move(anchors)), _nominal(1e9 * static_cast<double>(periodNum) / static_cast<double>(periodDen))
+        {
+            std::sort(_anchors.begin(), _anchors.end(), [](const ClockAnchor &a, const ClockAnchor &b) { return a.ticks < b.ticks; });
+            _anchors.erase(std::unique(_anchors.begin(), _anchors.end(), [](const ClockAnchor &a, const ClockAnchor &b) { return a.ticks == b.ticks; }), _anchors.end());
+            _rates.reserve(_anchors.size());
+            for (std::size_t i = 0; i + 1 < _anchors.size(); ++i) {
+                double rate = static_cast<double>(_anchors[i + 1].wall - _anchors[i].wall) / static_cast<double>(_anchors[i + 1].ticks - _anchors[i].ticks);
+                _rates.push_back(rate > 0.0 && std::isfinite(rate) ? rate : _nominal);
+            }
+            if (_rates.empty())
+                _rates.push_back(_nominal);
+        }
+
+        /**
+         *    @brief Tells if the timeline has anchors, hence maps onto the wall clock.
+         */
+        inline bool isAnchored() const
+        {
+            return !_anchors.empty();
+        }
+
+        /**
+         *    @brief Return the anchors, sorted by ticks.
+         */
+        inline const std::vector<ClockAnchor> &anchors() const
+        {
+            return _anchors;
+        }
+
+        /**
+         *    @brief Map ticks onto the wall clock timeline, in nanoseconds.
+         */
+        inline std::int64_t toWall(std::int64_t ticks) const
+        {
+            return map(ticks, segment(ticks, 0));
+        }
+
+        /**
+         *    @brief Map an array of ticks onto the wall clock timeline, in nanoseconds; it is fastest for increasing ticks,
+         *    which are mapped in a single pass over the anchors.
+         */
+        void toWall(const std::int64_t *ticks, std::int64_t *walls, std::size_t count) const
+        {
+            std::size_t hint = 0;
+            for (std::size_t i = 0; i < count; ++i) {
+                hint = segment(ticks[i], hint);
+                walls[i] = map(ticks[i], hint);
+            }
+        }
+
+    private:
+        /**
+         *    @brief Return the index of the anchor starting the segment of ticks, trying the hinted one and its successor
+         *    before searching.
+         */
+        inline std::size_t segment(std::int64_t ticks, std::size_t hint) const
+        {
+            std::size_t segments = _anchors.size() > 1 ? _anchors.size() - 1 : 1;
+            for (std::size_t i = hint; i < hint + 2 && i < segments; ++i)
+                if ((i == 0 || _anchors[i].ticks <= ticks) && (i + 1 >= segments || ticks < _anchors[i + 1].ticks))
+                    return i;
+            std::size_t upper = static_cast<std::size_t>(std::upper_bound(_anchors.begin(), _anchors.end(), ticks,
+                [](std::int64_t value, const ClockAnchor &anchor) { return value < anchor.ticks; }) - _anchors.begin());
+            return upper > 0 ? std::min(upper - 1, segments - 1) : 0;
+        }
+
+        inline std::int64_t map(std::int64_t ticks, std::size_t segment) const
+        {
+            if (_anchors.empty())
+                return static_cast<std::int64_t>(std::llround(static_cast<double>(ticks) * _nominal));
+            const ClockAnchor &anchor = _anchors[segment];
+            return anchor.wall + static_cast<std::int64_t>(std::llround(static_cast<double>(ticks - anchor.ticks) * _rates[segment]));
+        }
+
+        std::vector<ClockAnchor>    _anchors;   ///< The anchors, sorted by ticks.
+        std::vector<double>         _rates;     ///< The wall nanoseconds per tick from each anchor to the next.
+        double                      _nominal;   ///< The nominal nanoseconds per tick.
+    };
+
+}
+
+#endif // process_timing_clock_anchor_hpp
@@ -0,0 +1,178 @@
+#ifndef process_timing_clock_calibration_hpp
+#define process_timing_clock_calibration_hpp
+
+#include "process_timing.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace timings {
+
+    /**
+     *    @brief The ClockCalibration struct holds the bias a clock adds to every timing, i.e. the time measured by an empty
+     *    section, timed with back-to-back start() and stop() calls.
+     */
+    struct ClockCalibration {
+        std::chrono::nanoseconds    overhead;   ///< The median time of an empty section, to subtract from timings.
+        std::chrono::nanoseconds    minimum;    ///< The shortest time of an empty section.
+        std::chrono::nanoseconds    jitter;     ///< The median absolute deviation of the time of an empty section.
+        std::size_t                 samples;    ///< The number of empty sections timed.
+    };
+
+
+
+    /**
+     *    @brief Measure the overhead and jitter of a timing type, e.g. BasicProcessTiming<Clock, ThreadingPolicy::Shared>,
+     *    by timing empty sections with start() and stop(); it takes a few milliseconds for the default number of samples.
+     *    @param samples The number of empty sections timed, after as many warm-up ones; zero is taken as one.
+     */
+    template < class Timing >
+    ClockCalibration CalibrateTiming(std::size_t samples = 10000)
+    {
+        if (samples == 0)
+            samples = 1;
+        std::vector<std::int64_t> elapsed(samples);
+        Timing timing;
+        for (std::size_t pass = 0; pass < 2; ++pass) {
+            for (std::size_t i = 0; i < samples; ++i) {
+                timing.start();
+                timing.stop();
+                elapsed[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(timing.elapsed()).count();
+            }
+        }
+
+        std::vector<std::int64_t>::iterator middle = elapsed.begin() + static_cast<std::ptrdiff_t>(samples / 2);
+        std::nth_element(elapsed.begin(), middle, elapsed.end());
+        std::int64_t median = *middle;
+        std::int64_t minimum = *std::min_element(elapsed.begin(), elapsed.end());
+        for (std::int64_t &value : elapsed)
+            value = value > median ? value - median : median - value;
+        std::nth_element(elapsed.begin(), middle, elapsed.end());
+
+        ClockCalibration calibration;
+        calibration.overhead = std::chrono::nanoseconds(median);
+        calibration.minimum = std::chrono::nanoseconds(minimum);
+        calibration.jitter = std::chrono::nanoseconds(*middle);
+        calibration.samples = samples;
+        return calibration;
+    }
+
+    /**
+     *    @brief Measure the overhead and jitter of timing with a clock, with a single-threaded timing, i.e. the cost of
+     *    the clock reads alone; shared timings add the one of their sequence lock, see CalibrateTiming().
+     *    @param samples The number of empty sections timed, after as many warm-up ones; zero is taken as one.
+     */
+    template < class Clock >
+    ClockCalibration CalibrateClock(std::size_t samples = 10000)
+    {
+        return CalibrateTiming<BasicProcessTiming<Clock, ThreadingPolicy::Single>>(samples);
+    }
+
+    /**
+     *    @brief Return the calibration of a timing type, measured once, at the first call.
+     */
+    template < class Timing >
+    const ClockCalibration &TimingCalibrationOf()
+    {
+        static const ClockCalibration calibration = CalibrateTiming<Timing>();
+        return calibration;
+    }
+
+    /**
+     *    @brief Return the calibration of a clock, measured once, at the first call.
+     */
+    template < class Clock >
+    const ClockCalibration &ClockCalibrationOf()
+    {
+        return TimingCalibrationOf<BasicProcessTiming<Clock, ThreadingPolicy::Single>>();
+    }
+
+
+
+    namespace detail {
+
+        /**
+         *    @brief Return the calibration of a clock, or of a timing type, told apart by the Clock type of timings.
+         */
+        template < class ClockOrTiming >
+        inline auto CalibrationOf(int) -> decltype(std::declval<typename ClockOrTiming::Clock>(), TimingCalibrationOf<ClockOrTiming>())
+        {
+            return TimingCalibrationOf<ClockOrTiming>();
+        }
+
+        template < class ClockOrTiming >
+        inline const ClockCalibration &CalibrationOf(long)
+        {
+            return ClockCalibrationOf<ClockOrTiming>();
+        }
+
+    }
+
+
+
+    /**
+     *    @brief The BiasCorrectedSink class forwards durations to another sink, e.g. a histogram or an accumulating timing,
+     *    less a bias clamped at zero, so that timings recorded by stop(sink) or scoped timings are corrected.
+     */
+    template < class Sink >
+    class BiasCorrectedSink {
+    public:
+        /**
+         *    @brief Wrap a sink.
+         *    @param sink The sink receiving the corrected durations; it must outlive this object.
+         *    @param bias The duration subtracted, e.g. ClockCalibrationOf<Clock>().overhead.
+         */
+        template < typename Rep, typename Period >
+        BiasCorrectedSink(Sink &sink, const std::chrono::duration<Rep,Period> &bias)
+            : _sink(sink), _bias(std::chrono::duration_cast<std::chrono::nanoseconds>(bias)) { }
+
+        /**
+         *    @brief Record a duration less the bias.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            _sink.record(detail::SubtractBias(std::chrono::duration_cast<std::chrono::nanoseconds>(duration), _bias));
+        }
+
+        /**
+         *    @brief Record a weighted duration less the bias, if the wrapped sink takes weights.
+         */
+        template < typename Rep, typename Period >
+        inline auto record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight) -> decltype(std::declval<Sink&>().record(std::chrono::nanoseconds(), weight), void())
+        {
+            _sink.record(detail::SubtractBias(std::chrono::duration_cast<std::chrono::nanoseconds>(duration), _bias), weight);
+        }
+
+        /**
+         *    @brief Return the bias subtracted.
+         */
+        inline std::chrono::nanoseconds bias() const
+        {
+            return _bias;
+        }
+
+    private:
+        Sink                       &_sink;  ///< The sink receiving the corrected durations.
+        std::chrono::nanoseconds    _bias;  ///< The duration subtracted.
+    };
+
+
+
+    /**
+     *    @brief Wrap a sink so that the calibrated overhead of a clock, or of a timing type such as a shared timing, is
+     *    subtracted from the durations it receives.
+     */
+    template < class ClockOrTiming, class Sink >
+    inline BiasCorrectedSink<Sink> MakeBiasCorrectedSink(Sink &sink)
+    {
+        return BiasCorrectedSink<Sink>(sink, detail::CalibrationOf<ClockOrTiming>(0).overhead);
+    }
+
+}
+
+#endif // process_timing_clock_calibration_hpp
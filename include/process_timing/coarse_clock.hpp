@@ -0,0 +1,182 @@
+#ifndef process_timing_coarse_clock_hpp
+#define process_timing_coarse_clock_hpp
+
+#include "platform.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#if defined(__linux__)
+    #include <time.h>
+    #if defined(CLOCK_MONOTONIC_COARSE)
+        #define PROCESS_TIMING_HAS_COARSE_MONOTONIC_CLOCK 1
+    #endif
+#endif
+
+namespace timings {
+
+    namespace detail {
+
+        /**
+         *    @brief The CoarseTick struct holds the cached time of CoarseClock, alone on its cache line, so that reading it
+         *    only misses when the ticker updates it.
+         */
+        struct alignas(CacheLineSize) CoarseTick {
+            std::atomic<std::int64_t>   nanoseconds{0}; ///< The steady clock time of the last tick.
+            std::atomic<std::int64_t>   resolution{0};  ///< The tick interval of the running ticker, zero if none.
+        };
+
+        /// The cached time of CoarseClock; constant-initialized, so reading it needs no initialization guard.
+        inline CoarseTick CoarseClockTick;
+
+    }
+
+
+
+    /**
+     *    @brief The CoarseClock class reads a time cached by a background CoarseClockTicker, so that now() is a single
+     *    relaxed load, whatever the number of threads reading it; its resolution is the interval of the ticker.
+     *
+     *    Its time points are the ones of std::chrono::steady_clock, rounded down to the last tick, hence comparable with
+     *    them. They stay still while no ticker runs, and are zero before the first one starts.
+     */
+    class CoarseClock {
+    public:
+        using rep           = std::int64_t;
+        using period        = std::nano;
+        using duration      = std::chrono::duration<rep, period>;
+        using time_point    = std::chrono::time_point<CoarseClock>;
+
+        static constexpr bool is_steady = true;
+
+        static inline time_point now()
+        {
+            return time_point(duration(detail::CoarseClockTick.nanoseconds.load(std::memory_order_relaxed)));
+        }
+
+        /**
+         *    @brief Tells if a ticker is running.
+         */
+        static inline bool isTicking()
+        {
+            return detail::CoarseClockTick.resolution.load(std::memory_order_relaxed) != 0;
+        }
+
+        /**
+         *    @brief Return the tick interval of the running ticker, or zero if none is.
+         */
+        static inline duration resolution()
+        {
+            return duration(detail::CoarseClockTick.resolution.load(std::memory_order_relaxed));
+        }
+
+        /**
+         *    @brief Update the cached time from std::chrono::steady_clock.
+         */
+        static inline void tick()
+        {
+            std::int64_t now = std::chrono::duration_cast<duration>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            detail::CoarseClockTick.nanoseconds.store(now, std::memory_order_relaxed);
+        }
+    };
+
+
+
+    /**
+     *    @brief The CoarseClockTicker class runs a thread updating the time of CoarseClock at a fixed interval, until
+     *    destruction. The time is updated once on construction, so that CoarseClock is usable at once. A single ticker
+     *    should run at a time.
+     */
+    class CoarseClockTicker {
+    public:
+        /**
+         *    @param resolution The tick interval: the finer, the more the ticker thread wakes up; it is taken as at least
+         *    one microsecond.
+         */
+        template < typename Rep, typename Period >
+        explicit CoarseClockTicker(const std::chrono::duration<Rep,Period> &resolution) : _stop(false)
+        {
+            std::chrono::nanoseconds interval = std::chrono::duration_cast<std::chrono::nanoseconds>(resolution);
+            if (interval < std::chrono::microseconds(1))
+                interval = std::chrono::microseconds(1);
+            CoarseClock::tick();
+            detail::CoarseClockTick.resolution.store(interval.count(), std::memory_order_relaxed);
+            _thread = std::thread([this, interval]() {
+                std::unique_lock<std::mutex> lock(_mutex);
+                std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+                for (;;) {
+                    // After oversleeping, e.g. a preemption, the schedule restarts from now rather than catching up with
+                    // a burst of ticks.
+                    next = std::max(next + interval, std::chrono::steady_clock::now());
+                    if (_wakeUp.wait_until(lock, next, [this]() { return _stop; }))
+                        break;
+                    CoarseClock::tick();
+                }
+            });
+        }
+
+        CoarseClockTicker(const CoarseClockTicker &) = delete;
+        CoarseClockTicker &operator=(const CoarseClockTicker &) = delete;
+
+        ~CoarseClockTicker()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _wakeUp.notify_one();
+            _thread.join();
+            detail::CoarseClockTick.resolution.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        std::mutex              _mutex;     ///< Protects _stop.
+        std::condition_variable _wakeUp;    ///< Wakes the thread up on destruction.
+        bool                    _stop;      ///< Tells the thread to stop.
+        std::thread             _thread;    ///< The ticking thread.
+    };
+
+
+
+#ifdef PROCESS_TIMING_HAS_COARSE_MONOTONIC_CLOCK
+    /**
+     *    @brief The CoarseMonotonicClock class reads CLOCK_MONOTONIC_COARSE, the monotonic time of the last kernel tick,
+     *    served by the vDSO without reading the hardware counter; it needs no ticker thread, but its resolution is the
+     *    one of the kernel tick, usually 1 to 4 milliseconds.
+     */
+    class CoarseMonotonicClock {
+    public:
+        using rep           = std::int64_t;
+        using period        = std::nano;
+        using duration      = std::chrono::duration<rep, period>;
+        using time_point    = std::chrono::time_point<CoarseMonotonicClock>;
+
+        static constexpr bool is_steady = true;
+
+        static inline time_point now()
+        {
+            struct timespec time;
+            clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+            return time_point(duration(static_cast<std::int64_t>(time.tv_sec) * 1000000000 + static_cast<std::int64_t>(time.tv_nsec)));
+        }
+
+        /**
+         *    @brief Return the resolution of the clock, i.e. the kernel tick.
+         */
+        static inline duration resolution()
+        {
+            struct timespec time;
+            clock_getres(CLOCK_MONOTONIC_COARSE, &time);
+            return duration(static_cast<std::int64_t>(time.tv_sec) * 1000000000 + static_cast<std::int64_t>(time.tv_nsec));
+        }
+    };
+#endif
+
+}
+
+#endif // process_timing_coarse_clock_hpp
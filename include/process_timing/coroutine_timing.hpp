@@ -0,0 +1,300 @@
+#ifndef process_timing_coroutine_timing_hpp
+#define process_timing_coroutine_timing_hpp
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+    #if __has_include(<coroutine>)
+        #define PROCESS_TIMING_HAS_COROUTINES 1
+    #endif
+#endif
+
+#ifdef PROCESS_TIMING_HAS_COROUTINES
+
+#include "process_timing.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace timings {
+
+    /**
+     *    @brief The BasicCoroutineTiming class splits the lifetime of a coroutine into active time, while it runs, and
+     *    suspended time, while it waits, e.g. queued on an executor or for I/O, whichever threads it is resumed on.
+     *
+     *    The clock is read once per suspension and once per resumption. A coroutine runs on one thread at a time and its
+     *    executor orders its suspensions and resumptions, so the state is made of plain members; it should be queried
+     *    by the coroutine itself or once it is done.
+     */
+    template < class ClockType >
+    class BasicCoroutineTiming : public ProcessTimingBase {
+    public:
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+        using Duration  = typename Clock::duration;
+
+        /**
+         *    @brief Default constructor. The coroutine is taken as running, as it is when its frame is created.
+         */
+        BasicCoroutineTiming() : _last(Clock::now()), _active(Duration::zero()), _suspended(Duration::zero()), _suspensions(0), _running(true) { }
+
+        /**
+         *    @brief Account the time since the last resumption as active.
+         */
+        inline void suspend()
+        {
+            if (_running) {
+                TimePoint now = Clock::now();
+                _active += now - _last;
+                _last = now;
+                _running = false;
+                ++_suspensions;
+            }
+        }
+
+        /**
+         *    @brief Account the time since the last suspension as suspended.
+         */
+        inline void resume()
+        {
+            if (!_running) {
+                TimePoint now = Clock::now();
+                _suspended += now - _last;
+                _last = now;
+                _running = true;
+            }
+        }
+
+        /**
+         *    @brief Take back the last suspension, when the coroutine did not suspend after all, e.g. because a bool
+         *    await_suspend() returned false: the time since is active and the suspension is not counted.
+         */
+        inline void cancelSuspension()
+        {
+            if (!_running) {
+                _running = true;
+                --_suspensions;
+            }
+        }
+
+        /**
+         *    @brief Returns if the coroutine is running.
+         */
+        inline bool isRunning() const
+        {
+            return _running;
+        }
+
+        /**
+         *    @brief Return the number of suspensions.
+         */
+        inline std::uint64_t suspensions() const
+        {
+            return _suspensions;
+        }
+
+        /**
+         *    @brief Return the time spent running, up to now if running.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> active() const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(_running ? _active + (Clock::now() - _last) : _active);
+        }
+
+        /**
+         *    @brief Return the time spent suspended, up to now if suspended.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> suspended() const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(_running ? _suspended : _suspended + (Clock::now() - _last));
+        }
+
+        /**
+         *    @brief Return the active time over the whole lifetime: close to 1 for CPU-bound coroutines, close to 0 for
+         *    ones waiting; zero if no time has elapsed.
+         */
+        inline double activeRatio() const
+        {
+            double active = this->active<double>().count();
+            double total = active + suspended<double>().count();
+            return total > 0.0 ? active / total : 0.0;
+        }
+
+        /**
+         *    @brief Return a string representation of the active time.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::string to_string() const
+        {
+            std::string timeStr;
+            TimeToString<Rep,Period>(active<Rep,Period>(), timeStr);
+            return timeStr;
+        }
+
+    private:
+        TimePoint       _last;          ///< The time point of the last suspension or resumption.
+        Duration        _active;        ///< The time spent running up to the last suspension.
+        Duration        _suspended;     ///< The time spent suspended up to the last resumption.
+        std::uint64_t   _suspensions;   ///< The number of suspensions.
+        bool            _running;       ///< Tells if the coroutine is running.
+    };
+
+
+
+    namespace detail {
+
+        template < class Awaitable >
+        inline auto GetAwaiter(Awaitable &&awaitable, int) -> decltype(std::forward<Awaitable>(awaitable).operator co_await())
+        {
+            return std::forward<Awaitable>(awaitable).operator co_await();
+        }
+
+        template < class Awaitable >
+        inline auto GetAwaiter(Awaitable &&awaitable, long) -> decltype(operator co_await(std::forward<Awaitable>(awaitable)))
+        {
+            return operator co_await(std::forward<Awaitable>(awaitable));
+        }
+
+        template < class Awaitable >
+        inline Awaitable &&GetAwaiter(Awaitable &&awaitable, ...)
+        {
+            return std::forward<Awaitable>(awaitable);
+        }
+
+        /**
+         *    @brief AwaiterOf is the type holding the awaiter of an awaitable: a reference to lvalue awaiters, a value otherwise.
+         */
+        template < class Awaitable >
+        using AwaiterOf = std::conditional_t<std::is_lvalue_reference<decltype(GetAwaiter(std::declval<Awaitable>(), 0))>::value,
+                                             decltype(GetAwaiter(std::declval<Awaitable>(), 0)),
+                                             std::remove_cv_t<std::remove_reference_t<decltype(GetAwaiter(std::declval<Awaitable>(), 0))>>>;
+
+    }
+
+
+
+    /**
+     *    @brief The TimedAwaiter class wraps an awaiter so that a coroutine timing is suspended when the awaiter suspends
+     *    the coroutine and resumed when the coroutine is resumed. Awaiters that complete without suspending cost nothing.
+     *    It is noexcept as the wrapped awaiter is, so that it can wrap the final suspension.
+     */
+    template < class Awaiter, class Clock >
+    class TimedAwaiter {
+    public:
+        template < class Inner >
+        TimedAwaiter(Inner &&awaiter, BasicCoroutineTiming<Clock> &timing) noexcept(std::is_nothrow_constructible<Awaiter, Inner &&>::value)
+            : _awaiter(std::forward<Inner>(awaiter)), _timing(timing), _suspended(false) { }
+
+        inline bool await_ready() noexcept(noexcept(std::declval<Awaiter &>().await_ready()))
+        {
+            return _awaiter.await_ready();
+        }
+
+        /**
+         *    @brief Suspend the timing, then the coroutine: the awaiter may resume it at once, on another thread. If the
+         *    awaiter declines to suspend, by returning false, the suspension is taken back.
+         */
+        template < class Promise >
+        inline auto await_suspend(std::coroutine_handle<Promise> handle) noexcept(noexcept(std::declval<Awaiter &>().await_suspend(handle)))
+        {
+            _suspended = true;
+            _timing.suspend();
+            if constexpr (std::is_same<decltype(_awaiter.await_suspend(handle)), bool>::value) {
+                if (!_awaiter.await_suspend(handle)) {
+                    _suspended = false;
+                    _timing.cancelSuspension();
+                    return false;
+                }
+                return true;
+            } else {
+                return _awaiter.await_suspend(handle);
+            }
+        }
+
+        inline decltype(auto) await_resume() noexcept(noexcept(std::declval<Awaiter &>().await_resume()))
+        {
+            if (_suspended)
+                _timing.resume();
+            return _awaiter.await_resume();
+        }
+
+    private:
+        Awaiter                         _awaiter;   ///< The wrapped awaiter.
+        BasicCoroutineTiming<Clock>    &_timing;    ///< The timing of the awaiting coroutine.
+        bool                            _suspended; ///< Tells if the coroutine has been suspended.
+    };
+
+
+
+    /**
+     *    @brief Wrap an awaitable so that awaiting it suspends and resumes a coroutine timing, for coroutines whose promise
+     *    type cannot derive from BasicTimedPromise: co_await TimedAwait(socket.read(), timing).
+     */
+    template < class Awaitable, class Clock >
+    inline TimedAwaiter<detail::AwaiterOf<Awaitable>, Clock> TimedAwait(Awaitable &&awaitable, BasicCoroutineTiming<Clock> &timing)
+    {
+        return TimedAwaiter<detail::AwaiterOf<Awaitable>, Clock>(detail::GetAwaiter(std::forward<Awaitable>(awaitable), 0), timing);
+    }
+
+
+
+    /**
+     *    @brief The BasicTimedPromise class is a base for promise types, timing the active and suspended time of their
+     *    coroutines: its await_transform() wraps every co_await of the coroutine body.
+     *
+     *    The initial and final suspensions are not transformed: promise types should wrap them with timed(), e.g.
+     *    initial_suspend() { return timed(std::suspend_always()); }, so that the time before the first resumption counts
+     *    as suspended and the active time stops at the final suspension.
+     */
+    template < class ClockType >
+    class BasicTimedPromise {
+    public:
+        using Clock = ClockType;
+
+        /**
+         *    @brief Wrap the awaitables of the co_await expressions of the coroutine.
+         */
+        template < class Awaitable >
+        inline TimedAwaiter<detail::AwaiterOf<Awaitable>, Clock> await_transform(Awaitable &&awaitable)
+        {
+            return timed(std::forward<Awaitable>(awaitable));
+        }
+
+        /**
+         *    @brief Wrap an awaitable, e.g. the ones of initial_suspend() and final_suspend().
+         */
+        template < class Awaitable >
+        inline TimedAwaiter<detail::AwaiterOf<Awaitable>, Clock> timed(Awaitable &&awaitable)
+        {
+            return TimedAwait(std::forward<Awaitable>(awaitable), _timing);
+        }
+
+        /**
+         *    @brief Return the timing of the coroutine.
+         */
+        inline const BasicCoroutineTiming<Clock> &timing() const
+        {
+            return _timing;
+        }
+
+    protected:
+        BasicCoroutineTiming<Clock> _timing;    ///< The timing of the coroutine.
+    };
+
+
+
+    /// The coroutine timing class, measuring with std::chrono::steady_clock.
+    using CoroutineTiming = BasicCoroutineTiming<std::chrono::steady_clock>;
+
+    /// The timed promise base class, measuring with std::chrono::steady_clock.
+    using TimedPromise = BasicTimedPromise<std::chrono::steady_clock>;
+
+}
+
+#endif // PROCESS_TIMING_HAS_COROUTINES
+
+#endif // process_timing_coroutine_timing_hpp
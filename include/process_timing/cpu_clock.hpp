@@ -0,0 +1,211 @@
+#ifndef process_timing_cpu_clock_hpp
+#define process_timing_cpu_clock_hpp
+
+#include "process_timing.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_WIN32)
+    #define PROCESS_TIMING_HAS_CPU_CLOCKS 1
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+    #include <time.h>
+    #if defined(CLOCK_THREAD_CPUTIME_ID) && defined(CLOCK_PROCESS_CPUTIME_ID)
+        #define PROCESS_TIMING_HAS_CPU_CLOCKS 1
+    #endif
+#endif
+
+#ifdef PROCESS_TIMING_HAS_CPU_CLOCKS
+
+namespace timings {
+
+    namespace detail {
+
+#if defined(_WIN32)
+        inline std::int64_t FileTimesToNanoseconds(const FILETIME &kernel, const FILETIME &user)
+        {
+            std::uint64_t k = (static_cast<std::uint64_t>(kernel.dwHighDateTime) << 32) | kernel.dwLowDateTime;
+            std::uint64_t u = (static_cast<std::uint64_t>(user.dwHighDateTime) << 32) | user.dwLowDateTime;
+            return static_cast<std::int64_t>((k + u) * 100);
+        }
+#else
+        inline std::int64_t ClockNanoseconds(clockid_t clock)
+        {
+            struct timespec time;
+            clock_gettime(clock, &time);
+            return static_cast<std::int64_t>(time.tv_sec) * 1000000000 + static_cast<std::int64_t>(time.tv_nsec);
+        }
+#endif
+
+    }
+
+
+
+    /**
+     *    @brief The ThreadCpuClock class measures the CPU time consumed by the calling thread, in user and kernel mode.
+     *
+     *    Its time points are only comparable within the same thread. On Linux, reading it is a system call, since the vDSO
+     *    only serves wall clocks; on Windows its resolution is the one of GetThreadTimes().
+     */
+    class ThreadCpuClock {
+    public:
+        using rep           = std::int64_t;
+        using period        = std::nano;
+        using duration      = std::chrono::duration<rep, period>;
+        using time_point    = std::chrono::time_point<ThreadCpuClock>;
+
+        static constexpr bool is_steady = false;
+
+        static inline time_point now()
+        {
+#if defined(_WIN32)
+            FILETIME creation, exit, kernel, user;
+            GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user);
+            return time_point(duration(detail::FileTimesToNanoseconds(kernel, user)));
+#else
+            return time_point(duration(detail::ClockNanoseconds(CLOCK_THREAD_CPUTIME_ID)));
+#endif
+        }
+    };
+
+
+
+    /**
+     *    @brief The ProcessCpuClock class measures the CPU time consumed by all the threads of the process, in user and
+     *    kernel mode.
+     */
+    class ProcessCpuClock {
+    public:
+        using rep           = std::int64_t;
+        using period        = std::nano;
+        using duration      = std::chrono::duration<rep, period>;
+        using time_point    = std::chrono::time_point<ProcessCpuClock>;
+
+        static constexpr bool is_steady = false;
+
+        static inline time_point now()
+        {
+#if defined(_WIN32)
+            FILETIME creation, exit, kernel, user;
+            GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+            return time_point(duration(detail::FileTimesToNanoseconds(kernel, user)));
+#else
+            return time_point(duration(detail::ClockNanoseconds(CLOCK_PROCESS_CPUTIME_ID)));
+#endif
+        }
+    };
+
+
+
+    /**
+     *    @brief The BasicCpuTiming class takes, with each start() and stop(), both a wall clock and a CPU clock timing, so as
+     *    to tell whether a section was computing or waiting, e.g. descheduled.
+     *
+     *    With ThreadCpuClock, start() and stop() must be called by the same thread. Objects are meant to be used by a
+     *    single thread.
+     */
+    template < class CpuClockType, class WallClockType = std::chrono::steady_clock >
+    class BasicCpuTiming : public ProcessTimingBase {
+    public:
+        using CpuClock  = CpuClockType;
+        using WallClock = WallClockType;
+
+        /**
+         *    @brief Default constructor, starting the counters, as the members do on construction.
+         */
+        BasicCpuTiming() = default;
+
+        /**
+         *    @brief Initialize the counters.
+         */
+        inline void start()
+        {
+            _wall.start();
+            _cpu.start();
+        }
+
+        /**
+         *    @brief Terminate the counters.
+         */
+        inline void stop()
+        {
+            _cpu.stop();
+            _wall.stop();
+        }
+
+        /**
+         *    @brief Returns if it's counting or not.
+         */
+        inline bool isRunning() const
+        {
+            return _wall.isRunning();
+        }
+
+        /**
+         *    @brief Return how much wall time has been elapsed since the start.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> elapsed() const
+        {
+            return _wall.template elapsed<Rep,Period>();
+        }
+
+        /**
+         *    @brief Return how much CPU time has been consumed since the start.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> cpuElapsed() const
+        {
+            return _cpu.template elapsed<Rep,Period>();
+        }
+
+        /**
+         *    @brief Return the CPU time over the wall time: below 1 when waiting, above 1 for a process clock when several
+         *    threads compute; zero if no wall time has elapsed.
+         */
+        inline double utilization() const
+        {
+            double wall = elapsed<double>().count();
+            return wall > 0.0 ? cpuElapsed<double>().count() / wall : 0.0;
+        }
+
+        /**
+         *    @brief Return a string representation of the elapsed wall time from the start.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::string to_string() const
+        {
+            return _wall.template to_string<Rep,Period>();
+        }
+
+        /**
+         *    @brief Return a string representation of the CPU time consumed from the start.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::string cpu_to_string() const
+        {
+            return _cpu.template to_string<Rep,Period>();
+        }
+
+    private:
+        BasicProcessTiming<WallClock, ThreadingPolicy::Single>  _wall;  ///< The wall clock timing, started first.
+        BasicProcessTiming<CpuClock, ThreadingPolicy::Single>   _cpu;   ///< The CPU clock timing, nested in the wall clock one.
+    };
+
+
+
+    /// The timing class measuring both wall time and the CPU time of the calling thread.
+    using ThreadCpuTiming = BasicCpuTiming<ThreadCpuClock>;
+
+    /// The timing class measuring both wall time and the CPU time of the process.
+    using ProcessCpuTiming = BasicCpuTiming<ProcessCpuClock>;
+
+}
+
+#endif // PROCESS_TIMING_HAS_CPU_CLOCKS
+
+#endif // process_timing_cpu_clock_hpp
@@ -0,0 +1,159 @@
+#ifndef process_timing_deadline_hpp
+#define process_timing_deadline_hpp
+
+#include "process_timing.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace timings {
+
+    /**
+     *    @brief The BasicDeadline class enforces a time budget: its expiry tick is computed once, on construction, so that
+     *    expired() is a single clock read and an integer comparison, with no conversion.
+     */
+    template < class ClockType >
+    class BasicDeadline {
+    public:
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+        using Duration  = typename Clock::duration;
+
+        /**
+         *    @brief Create a deadline expiring a budget after a time point. The budget is rounded up to clock ticks, and
+         *    expiries beyond the clock range are taken as never.
+         */
+        template < typename Rep, typename Period >
+        BasicDeadline(const TimePoint &start, const std::chrono::duration<Rep,Period> &budget) : _expiry(Expiry(start, budget)) { }
+
+        /**
+         *    @brief Create a deadline expiring a budget after the start of a timing.
+         */
+        template < ThreadingPolicy Policy, typename Rep, typename Period >
+        BasicDeadline(const BasicProcessTiming<Clock, Policy> &timing, const std::chrono::duration<Rep,Period> &budget)
+            : BasicDeadline(timing.getStartTime(), budget) { }
+
+        /**
+         *    @brief Create a deadline expiring a budget from now, as a null timing, e.g. a ProcessTiming with
+         *    PROCESS_TIMING_DISABLE defined, has no start: budgets are still enforced when timings are disabled, from the
+         *    construction of the deadline instead of the start of the timing.
+         */
+        template < typename Rep, typename Period >
+        BasicDeadline(const BasicNullProcessTiming<Clock> &, const std::chrono::duration<Rep,Period> &budget)
+            : BasicDeadline(Clock::now(), budget) { }
+
+        /**
+         *    @brief Create a deadline expiring a budget from now.
+         */
+        template < typename Rep, typename Period >
+        static BasicDeadline After(const std::chrono::duration<Rep,Period> &budget)
+        {
+            return BasicDeadline(Clock::now(), budget);
+        }
+
+        /**
+         *    @brief Tells if the deadline has passed.
+         */
+        inline bool expired() const
+        {
+            return Clock::now().time_since_epoch().count() >= _expiry;
+        }
+
+        /**
+         *    @brief Return the expiry time point.
+         */
+        inline TimePoint expiry() const
+        {
+            return TimePoint(Duration(_expiry));
+        }
+
+        /**
+         *    @brief Return the time left before the expiry, or zero if it has passed.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> remaining() const
+        {
+            Count now = Clock::now().time_since_epoch().count();
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(now < _expiry ? Duration(_expiry - now) : Duration::zero());
+        }
+
+    private:
+        using Count = typename Duration::rep;
+
+        template < typename Rep, typename Period >
+        static Count Expiry(const TimePoint &start, const std::chrono::duration<Rep,Period> &budget)
+        {
+            Count from = start.time_since_epoch().count();
+            if (budget <= std::chrono::duration<Rep,Period>::zero())
+                return from;
+            if (std::chrono::duration<double,Period>(budget) >= std::chrono::duration<double,typename Duration::period>(Duration::max()))
+                return Duration::max().count();
+            Count ticks = std::chrono::ceil<Duration>(budget).count();
+            return from > Duration::max().count() - ticks ? Duration::max().count() : from + ticks;
+        }
+
+        Count   _expiry;    ///< The expiry ticks from epoch.
+    };
+
+
+
+    /**
+     *    @brief The BasicCoarseDeadline class is a deadline reading the clock only once every interval calls to expired(),
+     *    for loops whose iterations are much shorter than a clock read; the expiry is then detected up to interval - 1
+     *    iterations late. Objects are meant to be used by a single thread.
+     */
+    template < class ClockType >
+    class BasicCoarseDeadline {
+    public:
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+
+        /**
+         *    @param deadline The deadline to check.
+         *    @param interval The number of calls to expired() per clock read; zero is taken as one. The first call reads
+         *    the clock.
+         */
+        BasicCoarseDeadline(const BasicDeadline<Clock> &deadline, std::uint32_t interval)
+            : _deadline(deadline), _interval(interval > 0 ? interval : 1), _countdown(1), _expired(false) { }
+
+        /**
+         *    @brief Tells if the deadline has passed, reading the clock only once every interval calls. Once it has
+         *    passed, the clock is not read anymore.
+         */
+        inline bool expired()
+        {
+            if (_expired)
+                return true;
+            if (--_countdown != 0)
+                return false;
+            _countdown = _interval;
+            _expired = _deadline.expired();
+            return _expired;
+        }
+
+        /**
+         *    @brief Return the checked deadline.
+         */
+        inline const BasicDeadline<Clock> &deadline() const
+        {
+            return _deadline;
+        }
+
+    private:
+        BasicDeadline<Clock>    _deadline;  ///< The checked deadline.
+        std::uint32_t           _interval;  ///< The number of calls per clock read.
+        std::uint32_t           _countdown; ///< The number of calls left up to the next clock read.
+        bool                    _expired;   ///< Tells if the deadline has been seen passed.
+    };
+
+
+
+    /// The deadline class, measuring with std::chrono::steady_clock.
+    using Deadline = BasicDeadline<std::chrono::steady_clock>;
+
+    /// The coarse deadline class, measuring with std::chrono::steady_clock.
+    using CoarseDeadline = BasicCoarseDeadline<std::chrono::steady_clock>;
+
+}
+
+#endif // process_timing_deadline_hpp
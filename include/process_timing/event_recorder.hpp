@@ -0,0 +1,316 @@
+#ifndef process_timing_event_recorder_hpp
+#define process_timing_event_recorder_hpp
+
+#include "platform.hpp"
+#include "scoped_timing.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#ifndef PROCESS_TIMING_EVENT_RING_CAPACITY
+    /// The number of events each thread can buffer before they are drained; must be a power of two.
+    #define PROCESS_TIMING_EVENT_RING_CAPACITY 4096
+#endif
+
+namespace timings {
+
+    /**
+     *    @brief The TimingEvent struct is a compact record of a timed section.
+     */
+    struct TimingEvent {
+        std::int64_t    start;      ///< The initial time point, in nanoseconds from the clock epoch.
+        std::int64_t    end;        ///< The final time point, in nanoseconds from the clock epoch.
+        std::uint32_t   nameId;     ///< The identifier of the section name.
+        std::uint32_t   threadId;   ///< The index of the recording thread.
+    };
+
+    static_assert(sizeof(TimingEvent) == 24, "TimingEvent is expected to be 24 bytes");
+
+
+
+    /**
+     *    @brief The EventRing class is a fixed-capacity, single-producer single-consumer ring buffer of timing events.
+     *
+     *    The producer and consumer indices live on separate cache lines, and the producer caches the consumer index, so
+     *    that it only reads the consumer cache line when the ring looks full.
+     */
+    template < std::size_t Capacity >
+    class EventRing {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        EventRing() : _head(0), _tailCache(0), _tail(0) { }
+
+        EventRing(const EventRing &) = delete;
+        EventRing &operator=(const EventRing &) = delete;
+
+        /**
+         *    @brief Append an event; only the producer thread may call it.
+         *    @return false if the ring is full, in which case the event is discarded.
+         */
+        inline bool tryPush(const TimingEvent &event)
+        {
+            std::size_t head = _head.load(std::memory_order_relaxed);
+            if (head - _tailCache >= Capacity) {
+                _tailCache = _tail.load(std::memory_order_acquire);
+                if (head - _tailCache >= Capacity)
+                    return false;
+            }
+            _events[head & (Capacity - 1)] = event;
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         *    @brief Pass the buffered events, oldest first, to consumer and remove them; only the consumer thread may call it.
+         *    @return The number of events consumed.
+         */
+        template < class Consumer >
+        inline std::size_t drain(Consumer &&consumer)
+        {
+            std::size_t tail = _tail.load(std::memory_order_relaxed);
+            std::size_t head = _head.load(std::memory_order_acquire);
+            for (std::size_t i = tail; i != head; ++i)
+                consumer(static_cast<const TimingEvent &>(_events[i & (Capacity - 1)]));
+            _tail.store(head, std::memory_order_release);
+            return head - tail;
+        }
+
+        /**
+         *    @brief Return the number of buffered events, as seen by the calling thread.
+         */
+        inline std::size_t size() const
+        {
+            return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+        }
+
+    private:
+        alignas(CacheLineSize) std::atomic<std::size_t>    _head;      ///< The index of the next event to write, owned by the producer.
+        std::size_t                                         _tailCache; ///< The last consumer index seen by the producer.
+        alignas(CacheLineSize) std::atomic<std::size_t>    _tail;      ///< The index of the next event to read, owned by the consumer.
+        alignas(CacheLineSize) TimingEvent                  _events[Capacity]; ///< The events.
+    };
+
+
+
+    /**
+     *    @brief The EventRecorder class collects timing events from all threads, each appending to its own ring, with no
+     *    contention between producers.
+     *
+     *    A thread gets its ring at its first record() call, reusing one released by an exited thread if possible; rings
+     *    are never freed. Events are dropped, and counted, when a ring is full. Consumers drain all the rings without
+     *    blocking the producers; concurrent drains are serialized by a mutex.
+     */
+    class EventRecorder {
+    public:
+        static const std::size_t RingCapacity = PROCESS_TIMING_EVENT_RING_CAPACITY;    ///< The number of events of each ring.
+
+        using Ring = EventRing<RingCapacity>;
+
+        EventRecorder() : _rings(nullptr) { }
+
+        EventRecorder(const EventRecorder &) = delete;
+        EventRecorder &operator=(const EventRecorder &) = delete;
+
+        /**
+         *    @brief Return the process-wide recorder. It is never destroyed, so threads can record until the very end.
+         */
+        static EventRecorder &Global()
+        {
+            static EventRecorder *recorder = detail::NewPermanent<EventRecorder>();
+            return *recorder;
+        }
+
+        /**
+         *    @brief Record an event of the calling thread into the global recorder.
+         *    @return false if the event was dropped because the ring of the calling thread is full.
+         */
+        static inline bool Record(std::uint32_t nameId, std::int64_t start, std::int64_t end)
+        {
+            ThreadRing &local = LocalRing();
+            if (local.node == nullptr)
+                local.node = Global().acquire();
+            TimingEvent event = { start, end, nameId, local.node->threadId };
+            if (local.node->ring.tryPush(event))
+                return true;
+            local.node->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        /**
+         *    @brief Pass all the buffered events to consumer, ring by ring, and remove them.
+         *    @return The number of events consumed.
+         */
+        template < class Consumer >
+        std::size_t drain(Consumer &&consumer)
+        {
+            std::lock_guard<std::mutex> lock(_drainMutex);
+            std::size_t count = 0;
+            for (Node *node = _rings.load(std::memory_order_acquire); node != nullptr; node = node->next)
+                count += node->ring.drain(consumer);
+            return count;
+        }
+
+        /**
+         *    @brief Return the number of events dropped so far because rings were full.
+         */
+        std::uint64_t dropped() const
+        {
+            std::uint64_t count = 0;
+            for (Node *node = _rings.load(std::memory_order_acquire); node != nullptr; node = node->next)
+                count += node->dropped.load(std::memory_order_relaxed);
+            return count;
+        }
+
+    private:
+        struct Node {
+            Node() : next(nullptr), owned(true), threadId(0), dropped(0) { }
+
+            Ring                        ring;       ///< The events of the owner thread.
+            Node                       *next;       ///< The next ring of the list.
+            std::atomic<bool>           owned;      ///< Tells if a thread records into the ring.
+            std::uint32_t               threadId;   ///< The index of the owner thread.
+            std::atomic<std::uint64_t>  dropped;    ///< The number of events dropped because the ring was full.
+        };
+
+        struct ThreadRing {
+            ThreadRing() : node(nullptr) { }
+
+            ~ThreadRing()
+            {
+                if (node != nullptr) {
+                    node->owned.store(false, std::memory_order_release);
+                    // A later record from another thread-local destructor then takes a ring of its own.
+                    node = nullptr;
+                }
+            }
+
+            Node   *node;   ///< The ring of the thread.
+        };
+
+        static ThreadRing &LocalRing()
+        {
+            thread_local ThreadRing local;
+            return local;
+        }
+
+        Node *acquire()
+        {
+            std::uint32_t threadId = detail::ThreadIndex();
+            for (Node *node = _rings.load(std::memory_order_acquire); node != nullptr; node = node->next) {
+                bool owned = false;
+                if (!node->owned.load(std::memory_order_relaxed) && node->owned.compare_exchange_strong(owned, true, std::memory_order_acquire)) {
+                    node->threadId = threadId;
+                    return node;
+                }
+            }
+            Node *node = detail::NewPermanent<Node>();
+            node->threadId = threadId;
+            node->next = _rings.load(std::memory_order_relaxed);
+            while (!_rings.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+                ;
+            return node;
+        }
+
+        std::atomic<Node*>  _rings;         ///< The list of rings, grown at its head.
+        std::mutex          _drainMutex;    ///< Serializes the consumers.
+    };
+
+
+
+    /**
+     *    @brief The EventSink class is a sink appending timing events with the given name identifier to the global recorder.
+     */
+    class EventSink {
+    public:
+        explicit EventSink(std::uint32_t nameId) : _nameId(nameId) { }
+
+        template < class Clock, class Duration >
+        inline void record(const std::chrono::time_point<Clock,Duration> &start, const std::chrono::time_point<Clock,Duration> &end)
+        {
+            EventRecorder::Record(_nameId, std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count(),
+                                  std::chrono::duration_cast<std::chrono::nanoseconds>(end.time_since_epoch()).count());
+        }
+
+    private:
+        std::uint32_t   _nameId;    ///< The identifier of the section name.
+    };
+
+
+
+    /**
+     *    @brief The ScopedEvent class records its own lifetime as a timing event into the global recorder.
+     */
+    class ScopedEvent {
+    public:
+        explicit ScopedEvent(std::uint32_t nameId) : _sink(nameId), _timing(_sink) { }
+
+    private:
+        EventSink                   _sink;      ///< The sink of the event; declared first, so it outlives the timing.
+        ScopedTiming<EventSink>     _timing;    ///< The timing of the scope.
+    };
+
+
+
+    /**
+     *    @brief The BackgroundDrain class runs a thread draining the global recorder into a consumer at a fixed interval,
+     *    until destruction, when it drains one last time.
+     */
+    class BackgroundDrain {
+    public:
+        template < class Consumer, typename Rep, typename Period >
+        BackgroundDrain(Consumer consumer, const std::chrono::duration<Rep,Period> &interval) : _stop(false)
+        {
+            _thread = std::thread([this, consumer, interval]() mutable {
+                std::unique_lock<std::mutex> lock(_mutex);
+                for (;;) {
+                    bool stop = _wakeUp.wait_for(lock, interval, [this]() { return _stop; });
+                    lock.unlock();
+                    EventRecorder::Global().drain(consumer);
+                    if (stop)
+                        break;
+                    lock.lock();
+                }
+            });
+        }
+
+        BackgroundDrain(const BackgroundDrain &) = delete;
+        BackgroundDrain &operator=(const BackgroundDrain &) = delete;
+
+        ~BackgroundDrain()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _wakeUp.notify_one();
+            _thread.join();
+        }
+
+    private:
+        std::mutex              _mutex;     ///< Protects _stop.
+        std::condition_variable _wakeUp;    ///< Wakes the thread up on destruction.
+        bool                    _stop;      ///< Tells the thread to stop.
+        std::thread             _thread;    ///< The draining thread.
+    };
+
+}
+
+
+
+/**
+ *    @brief PROCESS_TIMING_EVENT_SCOPE(nameId) records the rest of the enclosing scope as a timing event.
+ *    When PROCESS_TIMING_DISABLE is defined, it expands to nothing.
+ */
+#ifdef PROCESS_TIMING_DISABLE
+    #define PROCESS_TIMING_EVENT_SCOPE(nameId) static_cast<void>(sizeof(nameId))
+#else
+    #define PROCESS_TIMING_EVENT_SCOPE(nameId) ::timings::ScopedEvent PROCESS_TIMING_UNIQUE_NAME(processTimingEvent)(nameId)
+#endif
+
+#endif // process_timing_event_recorder_hpp
@@ -0,0 +1,278 @@
+#ifndef process_timing_latency_histogram_hpp
+#define process_timing_latency_histogram_hpp
+
+#include "platform.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace timings {
+
+    /**
+     *    @brief The HistogramBuckets struct maps nanosecond values onto log-linear buckets.
+     *
+     *    Values below 2^(Precision+1) have a bucket each; above, every power-of-two range is split into 2^Precision buckets,
+     *    so that a bucket never spans more than 1/2^Precision of its values.
+     */
+    template < unsigned Precision >
+    struct HistogramBuckets {
+        static_assert(Precision >= 1 && Precision <= 16, "Precision must be in [1,16]");
+
+        static const std::size_t Count = static_cast<std::size_t>(65 - Precision) << Precision; ///< The number of buckets.
+
+        /**
+         *    @brief Return the bucket of a value.
+         */
+        static inline std::size_t Index(std::uint64_t value)
+        {
+            unsigned msb = detail::MostSignificantBit(value | 1);
+            unsigned group = msb > Precision ? msb - Precision : 0;
+            return (static_cast<std::size_t>(group) << Precision) + static_cast<std::size_t>(value >> group);
+        }
+
+        /**
+         *    @brief Return the smallest value of a bucket.
+         */
+        static inline std::uint64_t LowestValue(std::size_t index)
+        {
+            std::size_t high = index >> Precision;
+            unsigned group = high > 0 ? static_cast<unsigned>(high - 1) : 0;
+            return static_cast<std::uint64_t>(index - (static_cast<std::size_t>(group) << Precision)) << group;
+        }
+
+        /**
+         *    @brief Return the largest value of a bucket.
+         */
+        static inline std::uint64_t HighestValue(std::size_t index)
+        {
+            std::size_t high = index >> Precision;
+            unsigned group = high > 0 ? static_cast<unsigned>(high - 1) : 0;
+            return LowestValue(index) + ((std::uint64_t(1) << group) - 1);
+        }
+
+        /**
+         *    @brief Convert a duration into non-negative nanoseconds.
+         */
+        template < typename Rep, typename Period >
+        static inline std::uint64_t Nanoseconds(const std::chrono::duration<Rep,Period> &duration)
+        {
+            std::chrono::nanoseconds::rep ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            return ns > 0 ? static_cast<std::uint64_t>(ns) : 0;
+        }
+    };
+
+
+
+    /**
+     *    @brief The HistogramSnapshot class holds merged bucket counts of a histogram and answers quantile queries on them.
+     */
+    template < unsigned Precision >
+    class HistogramSnapshot {
+    public:
+        using Buckets = HistogramBuckets<Precision>;
+
+        HistogramSnapshot() : _count(0)
+        {
+            for (std::size_t i = 0; i < Buckets::Count; ++i)
+                _counts[i] = 0;
+        }
+
+        /**
+         *    @brief Add a number of values to a bucket.
+         */
+        inline void add(std::size_t index, std::uint64_t count)
+        {
+            _counts[index] += count;
+            _count += count;
+        }
+
+        /**
+         *    @brief Return the number of values of a bucket.
+         */
+        inline std::uint64_t bucket(std::size_t index) const
+        {
+            return _counts[index];
+        }
+
+        /**
+         *    @brief Return the number of recorded values.
+         */
+        inline std::uint64_t count() const
+        {
+            return _count;
+        }
+
+        /**
+         *    @brief Return the value below or at which the given fraction of the recorded values lies, e.g. 0.99 for p99.
+         *    The result is the highest value of the bucket, or zero if there is no value.
+         */
+        inline std::chrono::nanoseconds quantile(double fraction) const
+        {
+            if (_count == 0)
+                return std::chrono::nanoseconds::zero();
+            if (fraction < 0.0)
+                fraction = 0.0;
+            std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(_count)));
+            if (rank < 1)
+                rank = 1;
+            if (rank > _count)
+                rank = _count;
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < Buckets::Count; ++i) {
+                seen += _counts[i];
+                if (seen >= rank)
+                    return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(Buckets::HighestValue(i)));
+            }
+            return max();
+        }
+
+        /**
+         *    @brief Return the lowest recorded value, with the precision of the buckets.
+         */
+        inline std::chrono::nanoseconds min() const
+        {
+            for (std::size_t i = 0; i < Buckets::Count; ++i)
+                if (_counts[i] > 0)
+                    return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(Buckets::LowestValue(i)));
+            return std::chrono::nanoseconds::zero();
+        }
+
+        /**
+         *    @brief Return the highest recorded value, with the precision of the buckets.
+         */
+        inline std::chrono::nanoseconds max() const
+        {
+            for (std::size_t i = Buckets::Count; i > 0; --i)
+                if (_counts[i - 1] > 0)
+                    return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(Buckets::HighestValue(i - 1)));
+            return std::chrono::nanoseconds::zero();
+        }
+
+        /**
+         *    @brief Return the average of the recorded values, taking each as the middle of its bucket.
+         */
+        inline std::chrono::duration<double,std::nano> mean() const
+        {
+            if (_count == 0)
+                return std::chrono::duration<double,std::nano>::zero();
+            double sum = 0.0;
+            for (std::size_t i = 0; i < Buckets::Count; ++i)
+                if (_counts[i] > 0)
+                    sum += static_cast<double>(_counts[i]) * 0.5 * (static_cast<double>(Buckets::LowestValue(i)) + static_cast<double>(Buckets::HighestValue(i)));
+            return std::chrono::duration<double,std::nano>(sum / static_cast<double>(_count));
+        }
+
+    private:
+        std::uint64_t   _counts[Buckets::Count];    ///< The number of values of each bucket.
+        std::uint64_t   _count;                     ///< The number of values.
+    };
+
+
+
+    /**
+     *    @brief The BasicLatencyHistogram class records durations into fixed-memory log-linear buckets over nanoseconds.
+     *
+     *    Recording is lock-free: each thread increments, with a single relaxed operation, the buckets of its own shard,
+     *    chosen by thread index, so threads do not contend as long as they are no more than Shards.
+     *    Queries merge the shards into a HistogramSnapshot, in O(Shards * buckets).
+     */
+    template < unsigned Precision = 5, std::size_t Shards = 8 >
+    class BasicLatencyHistogram {
+    public:
+        using Buckets   = HistogramBuckets<Precision>;
+        using Snapshot  = HistogramSnapshot<Precision>;
+
+        static_assert(Shards > 0, "Shards must be positive");
+
+        BasicLatencyHistogram()
+        {
+            reset();
+        }
+
+        BasicLatencyHistogram(const BasicLatencyHistogram &) = delete;
+        BasicLatencyHistogram &operator=(const BasicLatencyHistogram &) = delete;
+
+        /**
+         *    @brief Record a duration.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            Shard &shard = _shards[detail::ThreadIndex() % Shards];
+            shard.counts[Buckets::Index(Buckets::Nanoseconds(duration))].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         *    @brief Record a duration standing for weight durations, e.g. one sample out of weight timed sections.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight)
+        {
+            Shard &shard = _shards[detail::ThreadIndex() % Shards];
+            shard.counts[Buckets::Index(Buckets::Nanoseconds(duration))].fetch_add(weight, std::memory_order_relaxed);
+        }
+
+        /**
+         *    @brief Forget all the recorded durations. Durations recorded concurrently may or may not be kept.
+         */
+        inline void reset()
+        {
+            for (std::size_t s = 0; s < Shards; ++s)
+                for (std::size_t i = 0; i < Buckets::Count; ++i)
+                    _shards[s].counts[i].store(0, std::memory_order_relaxed);
+        }
+
+        /**
+         *    @brief Merge the shards into a snapshot.
+         */
+        inline void snapshot(Snapshot &snapshot) const
+        {
+            for (std::size_t s = 0; s < Shards; ++s)
+                for (std::size_t i = 0; i < Buckets::Count; ++i) {
+                    std::uint64_t count = _shards[s].counts[i].load(std::memory_order_relaxed);
+                    if (count > 0)
+                        snapshot.add(i, count);
+                }
+        }
+
+        /**
+         *    @brief Return the value below or at which the given fraction of the recorded durations lies, e.g. 0.99 for p99.
+         */
+        inline std::chrono::nanoseconds quantile(double fraction) const
+        {
+            Snapshot merged;
+            snapshot(merged);
+            return merged.quantile(fraction);
+        }
+
+        /**
+         *    @brief Return the number of recorded durations.
+         */
+        inline std::uint64_t count() const
+        {
+            std::uint64_t count = 0;
+            for (std::size_t s = 0; s < Shards; ++s)
+                for (std::size_t i = 0; i < Buckets::Count; ++i)
+                    count += _shards[s].counts[i].load(std::memory_order_relaxed);
+            return count;
+        }
+
+    private:
+        struct alignas(CacheLineSize) Shard {
+            std::atomic<std::uint64_t>  counts[Buckets::Count];     ///< The number of durations of each bucket.
+        };
+
+        Shard   _shards[Shards];    ///< The per-thread buckets.
+    };
+
+
+
+    /// The default histogram: buckets within 1/32 of their values, 8 shards.
+    using LatencyHistogram = BasicLatencyHistogram<>;
+
+}
+
+#endif // process_timing_latency_histogram_hpp
@@ -0,0 +1,109 @@
+#ifndef process_timing_name_registry_hpp
+#define process_timing_name_registry_hpp
+
+#include "platform.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#ifndef PROCESS_TIMING_MAX_NAMES
+    /// The maximum number of names the registry can intern.
+    #define PROCESS_TIMING_MAX_NAMES 4096
+#endif
+
+namespace timings {
+
+    /**
+     *    @brief Return the 32 bits FNV-1a hash of a null-terminated string; usable in constant expressions.
+     */
+    constexpr std::uint32_t Fnv1a(const char *str, std::uint32_t hash = 2166136261u)
+    {
+        return *str == '\0' ? hash : Fnv1a(str + 1, (hash ^ static_cast<std::uint32_t>(static_cast<unsigned char>(*str))) * 16777619u);
+    }
+
+
+
+    /**
+     *    @brief The NameRegistry class interns names into small, dense integer identifiers, assigned in order of registration.
+     *
+     *    Interning takes a mutex and is meant to be done once per call site, e.g. into a static local variable; looking a
+     *    name up from its identifier is lock-free. Names beyond the capacity are all given the identifier Overflow.
+     */
+    class NameRegistry {
+    public:
+        static const std::size_t    Capacity    = PROCESS_TIMING_MAX_NAMES;  ///< The maximum number of names.
+        static const std::uint32_t  Overflow    = static_cast<std::uint32_t>(Capacity);    ///< The identifier given when the registry is full.
+
+        NameRegistry() : _size(0) { }
+
+        NameRegistry(const NameRegistry &) = delete;
+        NameRegistry &operator=(const NameRegistry &) = delete;
+
+        /**
+         *    @brief Return the process-wide registry. It is never destroyed.
+         */
+        static NameRegistry &Global()
+        {
+            static NameRegistry *registry = detail::NewPermanent<NameRegistry>();
+            return *registry;
+        }
+
+        /**
+         *    @brief Return the identifier of a name, registering it if needed.
+         */
+        std::uint32_t intern(const char *name)
+        {
+            std::uint32_t hash = Fnv1a(name);
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto range = _ids.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it)
+                if (std::strcmp(_names[it->second], name) == 0)
+                    return it->second;
+            std::size_t size = _size.load(std::memory_order_relaxed);
+            if (size == Capacity)
+                return Overflow;
+            std::size_t length = std::strlen(name);
+            char *copy = new char[length + 1];
+            std::memcpy(copy, name, length + 1);
+            _names[size] = copy;
+            _ids.emplace(hash, static_cast<std::uint32_t>(size));
+            _size.store(size + 1, std::memory_order_release);
+            return static_cast<std::uint32_t>(size);
+        }
+
+        inline std::uint32_t intern(const std::string &name)
+        {
+            return intern(name.c_str());
+        }
+
+        /**
+         *    @brief Return the name of an identifier, or nullptr if it is not registered.
+         */
+        inline const char *name(std::uint32_t id) const
+        {
+            return id < _size.load(std::memory_order_acquire) ? _names[id] : nullptr;
+        }
+
+        /**
+         *    @brief Return the number of registered names.
+         */
+        inline std::size_t size() const
+        {
+            return _size.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::mutex                                              _mutex;             ///< Serializes the registrations.
+        std::unordered_multimap<std::uint32_t, std::uint32_t>   _ids;               ///< The identifiers by name hash.
+        const char                                             *_names[Capacity];   ///< The names by identifier, never freed.
+        std::atomic<std::size_t>                                _size;              ///< The number of registered names.
+    };
+
+}
+
+#endif // process_timing_name_registry_hpp
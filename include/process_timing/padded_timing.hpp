@@ -0,0 +1,28 @@
+#ifndef process_timing_padded_timing_hpp
+#define process_timing_padded_timing_hpp
+
+#include "platform.hpp"
+#include "process_timing.hpp"
+
+namespace timings {
+
+    /**
+     *    @brief The BasicPaddedProcessTiming class is a timing aligned to and filling whole cache lines, so that timings
+     *    stored next to each other, e.g. one per worker in an array, are never written on the same cache line.
+     *
+     *    Containers honor the alignment from C++17 on; before, use storage aligned by other means.
+     */
+    template < class ClockType, ThreadingPolicy Policy = ThreadingPolicy::Shared >
+    class alignas(CacheLineSize) BasicPaddedProcessTiming : public BasicProcessTiming<ClockType, Policy> {
+    };
+
+
+
+    /// The padded timing class, measuring with std::chrono::steady_clock.
+    using PaddedProcessTiming = BasicPaddedProcessTiming<std::chrono::steady_clock>;
+
+    static_assert(sizeof(PaddedProcessTiming) % CacheLineSize == 0, "a padded timing must fill whole cache lines");
+
+}
+
+#endif // process_timing_padded_timing_hpp
@@ -0,0 +1,318 @@
+#ifndef process_timing_perf_counters_hpp
+#define process_timing_perf_counters_hpp
+
+#if defined(__linux__)
+    #define PROCESS_TIMING_HAS_PERF_COUNTERS 1
+#endif
+
+#ifdef PROCESS_TIMING_HAS_PERF_COUNTERS
+
+#include "process_timing.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <linux/perf_event.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace timings {
+
+    /**
+     *    @brief PerfCounter lists the hardware counters captured by perf timings.
+     */
+    enum class PerfCounter : std::size_t {
+        Cycles,         ///< CPU cycles.
+        Instructions,   ///< Retired instructions.
+        CacheMisses,    ///< Last level cache misses.
+        BranchMisses,   ///< Mispredicted branches.
+        Count           ///< The number of counters.
+    };
+
+
+
+    /**
+     *    @brief The PerfSnapshot struct holds the values of the hardware counters at a point in time.
+     */
+    struct PerfSnapshot {
+        static const std::size_t Count = static_cast<std::size_t>(PerfCounter::Count);    ///< The number of counters.
+
+        std::uint64_t   values[Count];  ///< The counter values, by PerfCounter.
+
+        inline std::uint64_t operator[](PerfCounter counter) const
+        {
+            return values[static_cast<std::size_t>(counter)];
+        }
+    };
+
+
+
+    /**
+     *    @brief The PerfCounterGroup class opens, with perf_event_open, the hardware counters of the calling thread as one
+     *    group, so that they are always scheduled together, and reads them.
+     *
+     *    On x86, counters are read from user space with rdpmc, through the pages the kernel maps for each counter, at the
+     *    cost of a few dozen cycles each; otherwise, or when rdpmc is not allowed, a single read() of the group is made.
+     *    Opening may fail, e.g. in containers or with a restrictive kernel.perf_event_paranoid: then every value is zero.
+     */
+    class PerfCounterGroup {
+    public:
+        /**
+         *    @brief Open the counters of the calling thread, counting user-space events only.
+         */
+        PerfCounterGroup() : _userReads(true)
+        {
+            static const std::uint64_t configs[PerfSnapshot::Count] = {
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+            };
+            const std::size_t pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            for (std::size_t i = 0; i < PerfSnapshot::Count; ++i) {
+                _fds[i] = -1;
+                _pages[i] = nullptr;
+            }
+            for (std::size_t i = 0; i < PerfSnapshot::Count; ++i) {
+                struct perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.size = sizeof(attr);
+                attr.config = configs[i];
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP;
+                _fds[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : _fds[0], 0));
+                if (_fds[i] < 0) {
+                    close();
+                    return;
+                }
+                void *page = ::mmap(nullptr, pageSize, PROT_READ, MAP_SHARED, _fds[i], 0);
+                if (page == MAP_FAILED)
+                    _userReads = false;
+                else
+                    _pages[i] = static_cast<const perf_event_mmap_page*>(page);
+            }
+#if !(defined(__x86_64__) || defined(__i386__))
+            _userReads = false;
+#endif
+        }
+
+        PerfCounterGroup(const PerfCounterGroup &) = delete;
+        PerfCounterGroup &operator=(const PerfCounterGroup &) = delete;
+
+        ~PerfCounterGroup()
+        {
+            close();
+        }
+
+        /**
+         *    @brief Return the group of the calling thread, opened at the first call.
+         */
+        static PerfCounterGroup &Local()
+        {
+            thread_local PerfCounterGroup group;
+            return group;
+        }
+
+        /**
+         *    @brief Tells if the counters have been opened.
+         */
+        inline bool isAvailable() const
+        {
+            return _fds[0] >= 0;
+        }
+
+        /**
+         *    @brief Read the current values of the counters.
+         */
+        inline void read(PerfSnapshot &snapshot) const
+        {
+            if (_userReads) {
+                bool complete = true;
+                for (std::size_t i = 0; i < PerfSnapshot::Count && complete; ++i)
+                    complete = ReadUserPage(_pages[i], snapshot.values[i]);
+                if (complete)
+                    return;
+            }
+            readGroup(snapshot);
+        }
+
+    private:
+        /**
+         *    @brief Read a counter from its user page, following the kernel sequence lock; false if the counter is not
+         *    readable with rdpmc, e.g. not scheduled.
+         */
+        static inline bool ReadUserPage(const perf_event_mmap_page *page, std::uint64_t &value)
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            if (page == nullptr)
+                return false;
+            for (;;) {
+                std::uint32_t sequence = __atomic_load_n(&page->lock, __ATOMIC_ACQUIRE);
+                if (!page->cap_user_rdpmc)
+                    return false;
+                std::uint32_t index = page->index;
+                if (index == 0)
+                    return false;
+                std::int64_t count = page->offset;
+                std::uint32_t low, high;
+                __asm__ volatile("rdpmc" : "=a"(low), "=d"(high) : "c"(index - 1));
+                unsigned width = page->pmc_width;
+                std::int64_t pmc = static_cast<std::int64_t>((static_cast<std::uint64_t>(high) << 32) | low);
+                pmc = static_cast<std::int64_t>(static_cast<std::uint64_t>(pmc) << (64 - width)) >> (64 - width);
+                count += pmc;
+                __atomic_thread_fence(__ATOMIC_ACQUIRE);
+                if (__atomic_load_n(&page->lock, __ATOMIC_RELAXED) == sequence) {
+                    value = static_cast<std::uint64_t>(count);
+                    return true;
+                }
+            }
+#else
+            static_cast<void>(page);
+            static_cast<void>(value);
+            return false;
+#endif
+        }
+
+        void readGroup(PerfSnapshot &snapshot) const
+        {
+            std::uint64_t buffer[1 + PerfSnapshot::Count] = {};
+            if (_fds[0] < 0 || ::read(_fds[0], buffer, sizeof(buffer)) != static_cast<ssize_t>(sizeof(buffer))) {
+                for (std::size_t i = 0; i < PerfSnapshot::Count; ++i)
+                    snapshot.values[i] = 0;
+                return;
+            }
+            for (std::size_t i = 0; i < PerfSnapshot::Count; ++i)
+                snapshot.values[i] = buffer[1 + i];
+        }
+
+        void close()
+        {
+            const std::size_t pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            for (std::size_t i = PerfSnapshot::Count; i-- > 0; ) {
+                if (_pages[i] != nullptr)
+                    ::munmap(const_cast<perf_event_mmap_page*>(_pages[i]), pageSize);
+                if (_fds[i] >= 0)
+                    ::close(_fds[i]);
+                _pages[i] = nullptr;
+                _fds[i] = -1;
+            }
+            _userReads = false;
+        }
+
+        int                             _fds[PerfSnapshot::Count];      ///< The counter descriptors, the first being the group leader.
+        const perf_event_mmap_page     *_pages[PerfSnapshot::Count];    ///< The user pages of the counters.
+        bool                            _userReads;                     ///< Tells if the counters can be read with rdpmc.
+    };
+
+
+
+    /**
+     *    @brief The BasicPerfTiming class takes a timing together with the hardware counters of the calling thread, so that
+     *    each section reports its instructions per cycle and miss rates alongside its duration.
+     *
+     *    The counters are read just outside the clock reads. start() and stop() must be called by the same thread.
+     *    Objects are meant to be used by a single thread.
+     */
+    template < class ClockType >
+    class BasicPerfTiming : public ProcessTimingBase {
+    public:
+        using Clock = ClockType;
+
+        /**
+         *    @brief Default constructor.
+         */
+        BasicPerfTiming() : _group(PerfCounterGroup::Local()), _start(), _end()
+        {
+            start();
+        }
+
+        /**
+         *    @brief Initialize the counters.
+         */
+        inline void start()
+        {
+            _group.read(_start);
+            _timing.start();
+        }
+
+        /**
+         *    @brief Terminate the counters.
+         */
+        inline void stop()
+        {
+            _timing.stop();
+            _group.read(_end);
+        }
+
+        /**
+         *    @brief Tells if the hardware counters are available; if not, their counts are zero.
+         */
+        inline bool hasCounters() const
+        {
+            return _group.isAvailable();
+        }
+
+        /**
+         *    @brief Return how much time has been elapsed between start() and stop().
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> elapsed() const
+        {
+            return _timing.template elapsed<Rep,Period>();
+        }
+
+        /**
+         *    @brief Return how many events of a counter occurred between start() and stop().
+         */
+        inline std::uint64_t count(PerfCounter counter) const
+        {
+            return _end[counter] - _start[counter];
+        }
+
+        /**
+         *    @brief Return the instructions retired per cycle, or zero if no cycle was counted.
+         */
+        inline double ipc() const
+        {
+            std::uint64_t cycles = count(PerfCounter::Cycles);
+            return cycles > 0 ? static_cast<double>(count(PerfCounter::Instructions)) / static_cast<double>(cycles) : 0.0;
+        }
+
+        /**
+         *    @brief Return the events of a counter per thousand instructions, e.g. cache misses, or zero if no instruction
+         *    was counted.
+         */
+        inline double perKiloInstructions(PerfCounter counter) const
+        {
+            std::uint64_t instructions = count(PerfCounter::Instructions);
+            return instructions > 0 ? 1000.0 * static_cast<double>(count(counter)) / static_cast<double>(instructions) : 0.0;
+        }
+
+        /**
+         *    @brief Return a string representation of the elapsed time.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::string to_string() const
+        {
+            return _timing.template to_string<Rep,Period>();
+        }
+
+    private:
+        const PerfCounterGroup                              &_group;    ///< The counters of the thread.
+        BasicProcessTiming<Clock, ThreadingPolicy::Single>  _timing;    ///< The timing.
+        PerfSnapshot                                        _start;     ///< The counter values at start.
+        PerfSnapshot                                        _end;       ///< The counter values at stop.
+    };
+
+
+
+    /// The perf timing class, measuring with std::chrono::steady_clock.
+    using PerfTiming = BasicPerfTiming<std::chrono::steady_clock>;
+
+}
+
+#endif // PROCESS_TIMING_HAS_PERF_COUNTERS
+
+#endif // process_timing_perf_counters_hpp
@@ -0,0 +1,80 @@
+#ifndef process_timing_platform_hpp
+#define process_timing_platform_hpp
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace timings {
+
+    /**
+     *    @brief CacheLineSize is the size used to keep data written by different threads on different cache lines.
+     */
+    static const std::size_t CacheLineSize = 64;
+
+
+
+    namespace detail {
+
+        /**
+         *    @brief Allocate an object meant to live until the process ends, honoring its alignment even before C++17.
+         */
+        template < class T >
+        inline T *NewPermanent()
+        {
+#if defined(__cpp_aligned_new)
+            return new T();
+#else
+            void *storage = ::operator new(sizeof(T) + alignof(T));
+            std::uintptr_t address = (reinterpret_cast<std::uintptr_t>(storage) + alignof(T) - 1) & ~static_cast<std::uintptr_t>(alignof(T) - 1);
+            return new (reinterpret_cast<void*>(address)) T();
+#endif
+        }
+
+        /**
+         *    @brief Add to an atomic counter written by a single thread, without a read-modify-write operation.
+         */
+        inline void AddRelaxed(std::atomic<std::uint64_t> &counter, std::uint64_t value)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        }
+
+        /**
+         *    @brief Return a small index identifying the calling thread, assigned in order of first call.
+         */
+        inline unsigned ThreadIndex()
+        {
+            static std::atomic<unsigned> next(0);
+            thread_local unsigned index = next.fetch_add(1, std::memory_order_relaxed);
+            return index;
+        }
+
+        /**
+         *    @brief Return the position of the most significant set bit of a non-zero value.
+         */
+        inline unsigned MostSignificantBit(std::uint64_t value)
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long index;
+            _BitScanReverse64(&index, value);
+            return static_cast<unsigned>(index);
+#elif defined(__GNUC__)
+            return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+            unsigned index = 0;
+            while (value >>= 1)
+                ++index;
+            return index;
+#endif
+        }
+
+    }
+
+}
+
+#endif // process_timing_platform_hpp
@@ -3,9 +3,11 @@
 
 #include <chrono>
 #include <string>
-#include <sstream>
-#include <iomanip>
+#include <cstddef>
 #include <atomic>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
 
 namespace timings {
 
@@ -54,11 +56,398 @@ namespace timings {
 
 
 
-    /// Main class, providing methods for taking timings.
-    class ProcessTiming {
-		using Clock = std::chrono::steady_clock;
+    namespace detail {
+
+        /**
+         *    @brief The CharWriter class appends characters to a bounded buffer, counting the ones that do not fit.
+         */
+        class CharWriter {
+        public:
+            constexpr CharWriter(char *buffer, std::size_t size) : _buffer(buffer), _size(size), _length(0) { }
+
+            /**
+             *    @brief Append a character.
+             */
+            constexpr void put(char c)
+            {
+                if (_length < _size)
+                    _buffer[_length] = c;
+                ++_length;
+            }
+
+            /**
+             *    @brief Append an integer, left-padded with '0' up to width characters, as std::setw and std::setfill do.
+             */
+            template < typename Int >
+            constexpr void integer(Int value, std::size_t width)
+            {
+                unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+                char digits[20] = {};
+                std::size_t n = 0;
+                do {
+                    digits[n++] = static_cast<char>('0' + magnitude % 10);
+                    magnitude /= 10;
+                } while (magnitude > 0);
+                std::size_t length = n + (value < 0 ? 1 : 0);
+                for (; length < width; ++length)
+                    put('0');
+                if (value < 0)
+                    put('-');
+                while (n > 0)
+                    put(digits[--n]);
+            }
+
+            /**
+             *    @brief Append a time field, i.e. its integer value followed by its unit and a dot.
+             */
+            template < typename Int >
+            constexpr void field(Int value, std::size_t width, char unit0, char unit1 = '\0')
+            {
+                integer(value, width);
+                put(unit0);
+                if (unit1 != '\0')
+                    put(unit1);
+                put('.');
+            }
+
+            /**
+             *    @brief Return the number of characters appended so far, including the ones that did not fit.
+             */
+            constexpr std::size_t length() const
+            {
+                return _length;
+            }
+
+        private:
+            char           *_buffer;    ///< The output buffer.
+            std::size_t     _size;      ///< The size of the output buffer.
+            std::size_t     _length;    ///< The number of characters appended.
+        };
+
+        /**
+         *    @brief The FinestElement trait gives the finest time element shown for a Period, i.e. the one of the smallest
+         *    period not finer than Period, or void if Period is coarser than days.
+         */
+        template < class Period >
+        struct FinestElement {
+            using type =
+                std::conditional_t<ratio_less_equal<Period, std::chrono::nanoseconds::period>::value, std::chrono::nanoseconds,
+                std::conditional_t<ratio_less_equal<Period, std::chrono::microseconds::period>::value, std::chrono::microseconds,
+                std::conditional_t<ratio_less_equal<Period, std::chrono::milliseconds::period>::value, std::chrono::milliseconds,
+                std::conditional_t<ratio_less_equal<Period, std::chrono::seconds::period>::value, std::chrono::seconds,
+                std::conditional_t<ratio_less_equal<Period, std::chrono::minutes::period>::value, std::chrono::minutes,
+                std::conditional_t<ratio_less_equal<Period, std::chrono::hours::period>::value, std::chrono::hours,
+                std::conditional_t<ratio_less_equal<Period, days::period>::value, days, void>>>>>>>;
+        };
+
+        /**
+         *    @brief Move the whole elements out of a count of Unit into element, if it is not finer than Unit.
+         */
+        template < class Unit, class Element, typename Count >
+        constexpr void TakeElement(Count &remaining, Element &element)
+        {
+            if constexpr (ratio_less_equal<typename Unit::period, typename Element::period>::value) {
+                using PerElement = std::ratio_divide<typename Element::period, typename Unit::period>;
+                static_assert(PerElement::den == 1, "time elements must be multiples of each other");
+                element = Element(static_cast<typename Element::rep>(remaining / static_cast<Count>(PerElement::num)));
+                remaining %= static_cast<Count>(PerElement::num);
+            }
+        }
+
+        /**
+         *    @brief Append a time element if it is shown for Period and a coarser or this element is not zero.
+         */
+        template < class Period, class Element >
+        constexpr void WriteElement(CharWriter &writer, bool &activate, const Element &element, std::size_t width, char unit0, char unit1 = '\0')
+        {
+            if (element.count() > 0)
+                activate = true;
+            if constexpr (ratio_less_equal<Period, typename Element::period>::value) {
+                if (activate)
+                    writer.field(element.count(), width, unit0, unit1);
+            }
+        }
+
+    }
+
+
+
+    /**
+     *    @brief The TimeString class is a fixed-capacity, null-terminated string holding a time representation, that never allocates.
+     */
+    class TimeString {
+        friend class ProcessTimingBase;
+    public:
+        static const std::size_t Capacity = 51;    ///< Maximum length of a time representation of a duration: "dd...d.hh.mm.ss.mmm.uuu.nnn." with 19 digits days.
+
+        constexpr TimeString() : _data{}, _size(0) { }
+
+        constexpr const char *c_str() const { return _data; }
+        constexpr const char *data() const { return _data; }
+        constexpr std::size_t size() const { return _size; }
+        constexpr std::size_t length() const { return _size; }
+        constexpr bool empty() const { return _size == 0; }
+
+        /**
+         *    @brief Return a view of the characters; usable in constant expressions, e.g. compared with a literal.
+         */
+        constexpr std::string_view view() const
+        {
+            return std::string_view(_data, _size);
+        }
+
+        /**
+         *    @brief Return a copy as a std::string.
+         */
+        inline std::string str() const
+        {
+            return std::string(_data, _size);
+        }
+
+    private:
+        char            _data[Capacity + 1];    ///< The characters, null-terminated.
+        std::size_t     _size;                  ///< The number of characters.
+    };
+
+
+
+    /**
+     *    @brief ThreadingPolicy tells how a timing object can be accessed by threads.
+     */
+    enum class ThreadingPolicy {
+        Single,     ///< Owned by one thread: the state is made of plain integers, with no atomic operation at all.
+        Shared      ///< Started and stopped by one thread at a time, queried concurrently by any thread without locks.
+    };
+
+
+
+    namespace detail {
+
+        /**
+         *    @brief The TimingSnapshot struct is a consistent copy of the state of a timing.
+         */
+        template < typename Count >
+        struct TimingSnapshot {
+            Count   start;      ///< The initial time point ticks from epoch.
+            Count   end;        ///< The final time point ticks from epoch, meaningful only if not ongoing.
+            bool    ongoing;    ///< Tells if the counter is counting.
+        };
+
+        /**
+         *    @brief The TimingState class stores the state of a timing according to a threading policy.
+         */
+        template < typename Count, ThreadingPolicy Policy >
+        class TimingState;
+
+        template < typename Count >
+        class TimingState<Count, ThreadingPolicy::Single> {
+        public:
+            TimingState() : _start(), _end(), _ongoing(false) { }
+
+            explicit TimingState(const TimingSnapshot<Count> &snapshot) : _start(snapshot.start), _end(snapshot.end), _ongoing(snapshot.ongoing) { }
+
+            inline void setStart(Count start)
+            {
+                _start = start;
+                _ongoing = true;
+            }
+
+            inline void setEnd(Count end)
+            {
+                _end = end;
+                _ongoing = false;
+            }
+
+            inline bool ongoing() const
+            {
+                return _ongoing;
+            }
+
+            inline TimingSnapshot<Count> load() const
+            {
+                TimingSnapshot<Count> snapshot = { _start, _end, _ongoing };
+                return snapshot;
+            }
+
+            inline void store(const TimingSnapshot<Count> &snapshot)
+            {
+                _start = snapshot.start;
+                _end = snapshot.end;
+                _ongoing = snapshot.ongoing;
+            }
+
+        private:
+            Count   _start;     ///< The initial time point ticks from epoch.
+            Count   _end;       ///< The final time point ticks from epoch.
+            bool    _ongoing;   ///< Tells if the counter is counting.
+        };
+
+        /**
+         *    The shared state is a single-writer sequence lock: one packed word holds a "being written" bit, the ongoing bit
+         *    and a version, bumped by each write. Writers only issue relaxed and release stores (plain moves on x86), readers
+         *    retry until they observe the same even word before and after reading the ticks, so they never mix the start of
+         *    one run with the end of another. Copies take a consistent snapshot of the source and write it as one update, so
+         *    the source may be written concurrently, while the destination must not.
+         */
+        template < typename Count >
+        class TimingState<Count, ThreadingPolicy::Shared> {
+        public:
+            TimingState() : _state(0), _start(Count()), _end(Count()) { }
+
+            explicit TimingState(const TimingSnapshot<Count> &snapshot) : _state(snapshot.ongoing ? Ongoing : 0), _start(snapshot.start), _end(snapshot.end) { }
+
+            TimingState(const TimingState &other) : TimingState(other.load()) { }
+
+            TimingState &operator=(const TimingState &other)
+            {
+                if (this != &other)
+                    store(other.load());
+                return *this;
+            }
+
+            inline void setStart(Count start)
+            {
+                std::uint64_t state = beginWrite();
+                _start.store(start, std::memory_order_relaxed);
+                endWrite(state, Ongoing);
+            }
+
+            inline void setEnd(Count end)
+            {
+                std::uint64_t state = beginWrite();
+                _end.store(end, std::memory_order_relaxed);
+                endWrite(state, 0);
+            }
+
+            inline bool ongoing() const
+            {
+                return (_state.load(std::memory_order_acquire) & Ongoing) != 0;
+            }
+
+            inline TimingSnapshot<Count> load() const
+            {
+                for (;;) {
+                    std::uint64_t before = _state.load(std::memory_order_acquire);
+                    if (before & Writing)
+                        continue;
+                    TimingSnapshot<Count> snapshot = { _start.load(std::memory_order_relaxed), _end.load(std::memory_order_relaxed), (before & Ongoing) != 0 };
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (_state.load(std::memory_order_relaxed) == before)
+                        return snapshot;
+                }
+            }
+
+            inline void store(const TimingSnapshot<Count> &snapshot)
+            {
+                std::uint64_t state = beginWrite();
+                _start.store(snapshot.start, std::memory_order_relaxed);
+                _end.store(snapshot.end, std::memory_order_relaxed);
+                endWrite(state, snapshot.ongoing ? Ongoing : 0);
+            }
+
+        private:
+            static const std::uint64_t Writing = 1;    ///< The state bit telling that a write is in progress.
+            static const std::uint64_t Ongoing = 2;    ///< The state bit telling that the counter is counting.
+            static const std::uint64_t Version = 4;    ///< The increment of the version part of the state.
+
+            inline std::uint64_t beginWrite()
+            {
+                std::uint64_t state = _state.load(std::memory_order_relaxed);
+                _state.store(state | Writing, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                return state;
+            }
+
+            inline void endWrite(std::uint64_t state, std::uint64_t ongoing)
+            {
+                _state.store(((state & ~(Writing | Ongoing)) + Version) | ongoing, std::memory_order_release);
+            }
+
+            std::atomic<std::uint64_t>  _state; ///< Packed write bit, ongoing bit and version.
+            std::atomic<Count>          _start; ///< The initial time point ticks from epoch.
+            std::atomic<Count>          _end;   ///< The final time point ticks from epoch.
+        };
+
+
+        /**
+         *    @brief RecordInto passes a timed interval to a sink: as a (start, end) pair of time points if the sink has a
+         *    record(start, end) method, otherwise as a duration to its record(duration) method.
+         */
+        template < class Sink, class TimePoint >
+        inline auto RecordInto(Sink &sink, const TimePoint &start, const TimePoint &end, int) -> decltype(sink.record(start, end), void())
+        {
+            sink.record(start, end);
+        }
+
+        template < class Sink, class TimePoint >
+        inline void RecordInto(Sink &sink, const TimePoint &start, const TimePoint &end, long)
+        {
+            sink.record(end - start);
+        }
+
+        template < class Sink, class TimePoint >
+        inline void RecordInto(Sink &sink, const TimePoint &start, const TimePoint &end)
+        {
+            RecordInto(sink, start, end, 0);
+        }
+
+        /**
+         *    @brief SubtractBias removes a bias, e.g. the clock overhead, from a duration, clamping the result at zero.
+         */
+        template < typename Rep, typename Period, typename BiasRep, typename BiasPeriod >
+        constexpr std::chrono::duration<Rep,Period> SubtractBias(const std::chrono::duration<Rep,Period> &duration, const std::chrono::duration<BiasRep,BiasPeriod> &bias)
+        {
+            using Duration = std::chrono::duration<Rep,Period>;
+            return duration > bias ? duration - std::chrono::duration_cast<Duration>(bias) : Duration::zero();
+        }
+
+    }
+
+
+
+    /// Base class, providing the clock-independent conversions of durations into time elements and strings.
+    class ProcessTimingBase {
     public:
-		using TimePoint = Clock::time_point;
+        /**
+         *    @brief SplitTimeElements extracts elements from time.
+         *
+         *    Integral durations are converted once into their finest shown element, then split by divisions by constants;
+         *    the elements finer than Period are left zero. Floating-point durations are split down to nanoseconds.
+         *    @param duration The time to split.
+         *    @return The extracted elements.
+         */
+        template < typename Rep, typename Period >
+        static constexpr TimeElements SplitTimeElements(std::chrono::duration<Rep,Period> duration)
+        {
+            TimeElements timeElements{};
+            if constexpr (std::is_floating_point<Rep>::value) {
+                timeElements.d = std::chrono::duration_cast<days>(duration);
+                duration -= timeElements.d;
+                timeElements.h = std::chrono::duration_cast<std::chrono::hours>(duration);
+                duration -= timeElements.h;
+                timeElements.m = std::chrono::duration_cast<std::chrono::minutes>(duration);
+                duration -= timeElements.m;
+                timeElements.s = std::chrono::duration_cast<std::chrono::seconds>(duration);
+                duration -= timeElements.s;
+                timeElements.ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+                duration -= timeElements.ms;
+                timeElements.us = std::chrono::duration_cast<std::chrono::microseconds>(duration);
+                duration -= timeElements.us;
+                timeElements.ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+            } else if constexpr (!std::is_void<typename detail::FinestElement<Period>::type>::value) {
+                using Unit = typename detail::FinestElement<Period>::type;
+                using Count = std::common_type_t<Rep, typename Unit::rep>;
+                Count remaining = std::chrono::duration_cast<std::chrono::duration<Count, typename Unit::period>>(duration).count();
+                detail::TakeElement<Unit>(remaining, timeElements.d);
+                detail::TakeElement<Unit>(remaining, timeElements.h);
+                detail::TakeElement<Unit>(remaining, timeElements.m);
+                detail::TakeElement<Unit>(remaining, timeElements.s);
+                detail::TakeElement<Unit>(remaining, timeElements.ms);
+                detail::TakeElement<Unit>(remaining, timeElements.us);
+                detail::TakeElement<Unit>(remaining, timeElements.ns);
+            }
+            return timeElements;
+        }
 
         /**
          *    @brief SplitTimeElements extracts elements from time.
@@ -66,21 +455,31 @@ namespace timings {
          *    @param timeElements Elements to be extracted.
          */
         template < typename Rep, typename Period >
-        static void SplitTimeElements(std::chrono::duration<Rep,Period> duration, TimeElements &timeElements)
+        static constexpr void SplitTimeElements(std::chrono::duration<Rep,Period> duration, TimeElements &timeElements)
+        {
+            timeElements = SplitTimeElements(duration);
+        }
+
+        /**
+         *    @brief TimeElementsToChars converts a time into a string representation, writing into a caller-supplied buffer.
+         *    @param timeElements The time elements to convert.
+         *    @param buffer The output buffer. It is not null-terminated.
+         *    @param size The size of the output buffer. At most size characters are written.
+         *    @return The length of the whole representation; if greater than size, the output has been truncated.
+         */
+        template < class Period >
+        static constexpr std::size_t TimeElementsToChars(const TimeElements &timeElements, char *buffer, std::size_t size)
         {
-            timeElements.d = std::chrono::duration_cast<days>(duration);
-            duration -= timeElements.d;
-            timeElements.h = std::chrono::duration_cast<std::chrono::hours>(duration);
-            duration -= timeElements.h;
-            timeElements.m = std::chrono::duration_cast<std::chrono::minutes>(duration);
-            duration -= timeElements.m;
-            timeElements.s = std::chrono::duration_cast<std::chrono::seconds>(duration);
-            duration -= timeElements.s;
-            timeElements.ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
-            duration -= timeElements.ms;
-            timeElements.us = std::chrono::duration_cast<std::chrono::microseconds>(duration);
-            duration -= timeElements.us;
-            timeElements.ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+            detail::CharWriter writer(buffer, size);
+            bool activate = false;
+            detail::WriteElement<Period>(writer, activate, timeElements.d, 0, 'd');
+            detail::WriteElement<Period>(writer, activate, timeElements.h, 2, 'h');
+            detail::WriteElement<Period>(writer, activate, timeElements.m, 2, 'm');
+            detail::WriteElement<Period>(writer, activate, timeElements.s, 2, 's');
+            detail::WriteElement<Period>(writer, activate, timeElements.ms, 3, 'm', 's');
+            detail::WriteElement<Period>(writer, activate, timeElements.us, 3, 'u', 's');
+            detail::WriteElement<Period>(writer, activate, timeElements.ns, 3, 'n', 's');
+            return writer.length();
         }
 
         /**
@@ -91,37 +490,15 @@ namespace timings {
         template < class Period >
         static void TimeElementsToString(const TimeElements &timeElements, std::string &timeStr)
         {
-            std::ostringstream stream;
-            bool activate = false;
-            if (timeElements.d.count() > 0)
-                activate = true;
-            if (ratio_less_equal<Period, days::period>::value && activate)
-                stream << timeElements.d.count() << "d.";
-            if (timeElements.h.count() > 0)
-                activate = true;
-            if (ratio_less_equal<Period, std::chrono::hours::period>::value && activate)
-                stream << std::setw(2) << std::setfill('0') << timeElements.h.count() << "h.";
-            if (timeElements.m.count() > 0)
-                activate = true;
-            if (ratio_less_equal<Period, std::chrono::minutes::period>::value && activate)
-                stream << std::setw(2) << std::setfill('0') << timeElements.m.count() << "m.";
-            if (timeElements.s.count() > 0)
-                activate = true;
-            if (ratio_less_equal<Period, std::chrono::seconds::period>::value && activate)
-                stream << std::setw(2) << std::setfill('0') << timeElements.s.count() << "s.";
-            if (timeElements.ms.count() > 0)
-                activate = true;
-            if (ratio_less_equal<Period, std::chrono::milliseconds::period>::value && activate)
-                stream << std::setw(3) << std::setfill('0') << timeElements.ms.count() << "ms.";
-            if (timeElements.us.count() > 0)
-                activate = true;
-            if (ratio_less_equal<Period, std::chrono::microseconds::period>::value && activate)
-                stream << std::setw(3) << std::setfill('0') << timeElements.us.count() << "us.";
-            if (timeElements.ns.count() > 0)
-                activate = true;
-            if (ratio_less_equal<Period, std::chrono::nanoseconds::period>::value && activate)
-                stream << std::setw(3) << std::setfill('0') << timeElements.ns.count() << "ns.";
-            timeStr = stream.str();
+            char buffer[TimeString::Capacity];
+            std::size_t length = TimeElementsToChars<Period>(timeElements, buffer, TimeString::Capacity);
+            if (length <= TimeString::Capacity) {
+                timeStr.assign(buffer, length);
+            } else {
+                // Caller-built elements may be longer than any duration, e.g. with out-of-range fields.
+                timeStr.resize(length);
+                TimeElementsToChars<Period>(timeElements, &timeStr[0], length);
+            }
         }
 
         /**
@@ -132,29 +509,110 @@ namespace timings {
         template < typename Rep, typename Period >
         static void TimeToString(const std::chrono::duration<Rep,Period> &duration, std::string &timeStr)
         {
-            TimeElements timeElements;
-            SplitTimeElements(duration, timeElements);
-            TimeElementsToString<Period>(timeElements, timeStr);
+            TimeElementsToString<Period>(SplitTimeElements(duration), timeStr);
+        }
+
+        /**
+         *    @brief TimeToChars converts duration into a string representation, writing into a caller-supplied buffer.
+         *    @param duration The time to convert.
+         *    @param buffer The output buffer. It is not null-terminated.
+         *    @param size The size of the output buffer. At most size characters are written.
+         *    @return The length of the whole representation; if greater than size, the output has been truncated.
+         */
+        template < typename Rep, typename Period >
+        static constexpr std::size_t TimeToChars(const std::chrono::duration<Rep,Period> &duration, char *buffer, std::size_t size)
+        {
+            return TimeElementsToChars<Period>(SplitTimeElements(duration), buffer, size);
+        }
+
+        /**
+         *    @brief TimeToTimeString converts duration into a fixed-capacity string representation.
+         *    @param duration The time to convert.
+         *    @param timeStr The output string.
+         */
+        template < typename Rep, typename Period >
+        static constexpr void TimeToTimeString(const std::chrono::duration<Rep,Period> &duration, TimeString &timeStr)
+        {
+            std::size_t length = TimeToChars(duration, timeStr._data, TimeString::Capacity);
+            timeStr._size = length < TimeString::Capacity ? length : TimeString::Capacity;
+            timeStr._data[timeStr._size] = '\0';
         }
 
+        /**
+         *    @brief TimeToTimeString converts duration into a fixed-capacity string representation; usable in constant
+         *    expressions, e.g. static_assert(TimeToTimeString(std::chrono::milliseconds(1500)).view() == "01s.500ms.").
+         *    @param duration The time to convert.
+         *    @return The output string.
+         */
+        template < typename Rep, typename Period >
+        static constexpr TimeString TimeToTimeString(const std::chrono::duration<Rep,Period> &duration)
+        {
+            TimeString timeStr;
+            TimeToTimeString(duration, timeStr);
+            return timeStr;
+        }
+    };
+
 
 
+    /**
+     *    @brief The BasicTimingRecord struct is a finished timing: a trivially copyable pair of time points, to pass timings
+     *    by value and store them contiguously.
+     */
+    template < class ClockType >
+    struct BasicTimingRecord {
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+
+        TimePoint   start;  ///< The initial time point.
+        TimePoint   end;    ///< The final time point.
+
+        /**
+         *    @brief Return how much time has been elapsed between start and end.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        constexpr std::chrono::duration<Rep,Period> elapsed() const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(end - start);
+        }
+    };
+
+
+
+    /// Main class, providing methods for taking timings with the given clock and threading policy.
+    template < class ClockType, ThreadingPolicy Policy = ThreadingPolicy::Shared >
+    class BasicProcessTiming : public ProcessTimingBase {
+    public:
+        using Clock = ClockType;
+        using TimePoint = typename Clock::time_point;
+
         /**
          *    @brief Default constructor.
          */
-        ProcessTiming()
+        BasicProcessTiming()
         {
             start();
         }
 
+        /**
+         *    @brief Construct a stopped timing from a record.
+         */
+        explicit BasicProcessTiming(const BasicTimingRecord<Clock> &record)
+            : _state(detail::TimingSnapshot<TimePointDurationCount>{ record.start.time_since_epoch().count(), record.end.time_since_epoch().count(), false }) { }
+
+        /**
+         *    @brief Copy constructor, taking a consistent snapshot of the source state, also while the source is written by
+         *    another thread. Moves copy as well.
+         */
+        BasicProcessTiming(const BasicProcessTiming &) = default;
+        BasicProcessTiming &operator=(const BasicProcessTiming &) = default;
+
         /**
          *    @brief Initialize the counter.
          */
         inline void start()
         {
-			_startTimeCount = Clock::now().time_since_epoch().count();
-			_endTimeCount = _startTimeCount.load();
-            _ongoing = true;
+                _state.setStart(Clock::now().time_since_epoch().count());
         }
 
         /**
@@ -162,31 +620,49 @@ namespace timings {
          */
         inline void stop()
         {
-			_endTimeCount = Clock::now().time_since_epoch().count();
-            _ongoing = false;
+            _state.setEnd(Clock::now().time_since_epoch().count());
+        }
+
+        /**
+         *    @brief Terminate the counter and record the elapsed time into a sink, i.e. any object with a record(duration) method,
+         *    like an accumulating timing or a histogram, or with a record(start, end) method, like an event sink.
+         */
+        template < class Sink >
+        inline void stop(Sink &sink)
+        {
+            TimePoint end = Clock::now();
+            TimePoint start = TimePoint(TimePointDuration(_state.load().start));
+            _state.setEnd(end.time_since_epoch().count());
+            detail::RecordInto(sink, start, end);
         }
 
         /**
          *    @brief Return the initial time point.
          */
-        inline std::chrono::steady_clock::time_point getStartTime() const
+        inline TimePoint getStartTime() const
         {
-			TimePoint startTime;
-			startTime += TimePointDuration(_startTimeCount);
-            return startTime;
+            return TimePoint(TimePointDuration(_state.load().start));
         }
 
         /**
          *    @brief Return the final time point.
          */
-        inline std::chrono::steady_clock::time_point getEndTime() const
+        inline TimePoint getEndTime() const
         {
-            TimePoint endTime;
-            if (_ongoing)
-                endTime = Clock::now();
-			else
-				endTime += TimePointDuration(_endTimeCount);
-            return endTime;
+            detail::TimingSnapshot<TimePointDurationCount> snapshot = _state.load();
+            if (snapshot.ongoing)
+                return Clock::now();
+            return TimePoint(TimePointDuration(snapshot.end));
+        }
+
+        /**
+         *    @brief Return the initial and final time points as a record; the final one is now if it's counting.
+         */
+        inline BasicTimingRecord<Clock> record() const
+        {
+            detail::TimingSnapshot<TimePointDurationCount> snapshot = _state.load();
+            BasicTimingRecord<Clock> record = { TimePoint(TimePointDuration(snapshot.start)), snapshot.ongoing ? Clock::now() : TimePoint(TimePointDuration(snapshot.end)) };
+            return record;
         }
 
         /**
@@ -194,7 +670,7 @@ namespace timings {
          */
         inline bool isRunning() const
         {
-            return _ongoing;
+            return _state.ongoing();
         }
 
         /**
@@ -203,12 +679,19 @@ namespace timings {
         template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
         inline std::chrono::duration<Rep,Period> elapsed() const
         {
-            std::chrono::duration<Rep,Period> diff;
-            if (_ongoing)
-                diff = std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(Clock::now() - getStartTime());
-            else
-                diff = std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(getEndTime() - getStartTime());
-            return diff;
+            detail::TimingSnapshot<TimePointDurationCount> snapshot = _state.load();
+            TimePoint endTime = snapshot.ongoing ? Clock::now() : TimePoint(TimePointDuration(snapshot.end));
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(endTime - TimePoint(TimePointDuration(snapshot.start)));
+        }
+
+        /**
+         *    @brief Return how much time has been elapsed since the start, less a bias clamped at zero, e.g. the clock
+         *    overhead measured by CalibrateClock(), so that sections of a few clock reads are not overestimated.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period, typename BiasRep, typename BiasPeriod >
+        inline std::chrono::duration<Rep,Period> elapsed(const std::chrono::duration<BiasRep,BiasPeriod> &bias) const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(detail::SubtractBias(elapsed<typename TimePointDuration::rep, typename TimePointDuration::period>(), bias));
         }
 
         /**
@@ -223,15 +706,144 @@ namespace timings {
             return timeStr;
         }
 
+        /**
+         *    @brief Write a string representation of the elapsed time from the start into a caller-supplied buffer.
+         *    @param buffer The output buffer. It is not null-terminated.
+         *    @param size The size of the output buffer. At most size characters are written.
+         *    @return The length of the whole representation; if greater than size, the output has been truncated.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::size_t to_chars(char *buffer, std::size_t size) const
+        {
+            return TimeToChars<Rep,Period>(elapsed<Rep,Period>(), buffer, size);
+        }
+
+        /**
+         *    @brief Return a fixed-capacity string representation of the elapsed time from the start, without allocating.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline TimeString to_time_string() const
+        {
+            TimeString timeStr;
+            TimeToTimeString<Rep,Period>(elapsed<Rep,Period>(), timeStr);
+            return timeStr;
+        }
+
     private:
-		using TimePointDuration = TimePoint::duration;
-		using TimePointDurationCount = TimePointDuration::rep;
+        using TimePointDuration = typename TimePoint::duration;
+        using TimePointDurationCount = typename TimePointDuration::rep;
+
+        detail::TimingState<TimePointDurationCount, Policy>    _state;     ///< The initial and final time point ticks from epoch.
+    };
+
+
+
+    /**
+     *    @brief The BasicNullProcessTiming class has the interface of BasicProcessTiming, with constexpr no-ops: it never
+     *    reads the clock, holds no state and measures zero; sinks receive nothing. ProcessTiming and LocalProcessTiming
+     *    stand for it when PROCESS_TIMING_DISABLE is defined, so that disabled builds strip the timings they take.
+     */
+    template < class ClockType >
+    class BasicNullProcessTiming : public ProcessTimingBase {
+    public:
+        using Clock = ClockType;
+        using TimePoint = typename Clock::time_point;
+
+        constexpr BasicNullProcessTiming() = default;
+
+        constexpr explicit BasicNullProcessTiming(const BasicTimingRecord<Clock> &) { }
+
+        constexpr void start() { }
+
+        constexpr void stop() { }
+
+        template < class Sink >
+        constexpr void stop(Sink &) { }
+
+        constexpr TimePoint getStartTime() const
+        {
+            return TimePoint();
+        }
+
+        constexpr TimePoint getEndTime() const
+        {
+            return TimePoint();
+        }
+
+        constexpr BasicTimingRecord<Clock> record() const
+        {
+            return BasicTimingRecord<Clock>{ TimePoint(), TimePoint() };
+        }
+
+        constexpr bool isRunning() const
+        {
+            return false;
+        }
+
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        constexpr std::chrono::duration<Rep,Period> elapsed() const
+        {
+            return std::chrono::duration<Rep,Period>::zero();
+        }
+
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period, typename BiasRep, typename BiasPeriod >
+        constexpr std::chrono::duration<Rep,Period> elapsed(const std::chrono::duration<BiasRep,BiasPeriod> &) const
+        {
+            return std::chrono::duration<Rep,Period>::zero();
+        }
 
-		std::atomic_bool	                    _ongoing;       ///< Tells if the counter is counting.
-		std::atomic<TimePointDurationCount>     _startTimeCount;///< The initial time point ticks from epoch.
-		std::atomic<TimePointDurationCount>     _endTimeCount;  ///< The final time point ticks from epoch.
+        /**
+         *    @brief Return the string representation of a zero time.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::string to_string() const
+        {
+            std::string timeStr;
+            TimeToString<Rep,Period>(elapsed<Rep,Period>(), timeStr);
+            return timeStr;
+        }
+
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        constexpr std::size_t to_chars(char *buffer, std::size_t size) const
+        {
+            return TimeToChars<Rep,Period>(elapsed<Rep,Period>(), buffer, size);
+        }
+
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        constexpr TimeString to_time_string() const
+        {
+            return TimeToTimeString<Rep,Period>(elapsed<Rep,Period>());
+        }
     };
 
+
+
+    /// The null timing class, standing for steady_clock timings when PROCESS_TIMING_DISABLE is defined.
+    using NullProcessTiming = BasicNullProcessTiming<std::chrono::steady_clock>;
+
+    static_assert(std::is_empty<NullProcessTiming>::value && std::is_trivially_copyable<NullProcessTiming>::value, "NullProcessTiming must hold no state");
+    static_assert(NullProcessTiming().elapsed().count() == 0 && !NullProcessTiming().isRunning(), "NullProcessTiming must be usable in constant expressions");
+    static_assert(NullProcessTiming().to_time_string().view() == ProcessTimingBase::TimeToTimeString(std::chrono::nanoseconds::zero()).view(), "NullProcessTiming must format a zero time");
+
+#ifdef PROCESS_TIMING_DISABLE
+    /// The default timing class; disabled, taking no timing.
+    using ProcessTiming = NullProcessTiming;
+
+    /// The timing class for objects used by a single thread; disabled, taking no timing.
+    using LocalProcessTiming = NullProcessTiming;
+#else
+    /// The default timing class, measuring with std::chrono::steady_clock.
+    using ProcessTiming = BasicProcessTiming<std::chrono::steady_clock>;
+
+    /// The timing class for objects used by a single thread, measuring with std::chrono::steady_clock.
+    using LocalProcessTiming = BasicProcessTiming<std::chrono::steady_clock, ThreadingPolicy::Single>;
+#endif
+
+    /// The timing record class of timings measuring with std::chrono::steady_clock.
+    using TimingRecord = BasicTimingRecord<std::chrono::steady_clock>;
+
+    static_assert(std::is_trivially_copyable<TimingRecord>::value, "TimingRecord must be trivially copyable");
+
 }
 
 #endif // process_timing_hpp
@@ -0,0 +1,653 @@
+#ifndef process_timing_record_stream_hpp
+#define process_timing_record_stream_hpp
+
+#include "clock_anchor.hpp"
+#include "event_recorder.hpp"
+#include "process_timing.hpp"
+#include "trace_export.hpp"
+#include "tsc_clock.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define PROCESS_TIMING_HAS_RECORD_MAPPING 1
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace timings {
+
+    /**
+     *    @brief RecordClock identifies the clock the ticks of a record stream come from.
+     */
+    enum class RecordClock : std::uint32_t {
+        Unknown = 0,    ///< Any other clock.
+        Steady  = 1,    ///< std::chrono::steady_clock.
+        System  = 2,    ///< std::chrono::system_clock.
+        Tsc     = 3     ///< TscClock.
+    };
+
+    /**
+     *    @brief RecordKind tells which fields the records of a stream carry.
+     */
+    enum class RecordKind : std::uint32_t {
+        Records = 1,    ///< Start and end ticks, as TimingRecord.
+        Events  = 2     ///< Also the name and thread identifiers, as TimingEvent.
+    };
+
+
+
+    /**
+     *    @brief The RecordStreamHeader struct describes the records of a stream: their fields, clock and tick period.
+     */
+    struct RecordStreamHeader {
+        RecordKind      kind;           ///< The fields of the records.
+        RecordClock     clock;          ///< The clock of the ticks.
+        std::int64_t    periodNum;      ///< The tick period numerator, in seconds.
+        std::int64_t    periodDen;      ///< The tick period denominator, in seconds.
+
+        /**
+         *    @brief Return the header of the records of a clock, e.g. BasicTimingRecord<Clock>.
+         */
+        template < class Clock >
+        static RecordStreamHeader For(RecordKind kind = RecordKind::Records);
+
+        /**
+         *    @brief Return the header of timing events, whose ticks are nanoseconds of a clock.
+         */
+        template < class Clock = std::chrono::steady_clock >
+        static RecordStreamHeader ForEvents()
+        {
+            RecordStreamHeader header = For<Clock>(RecordKind::Events);
+            header.periodNum = 1;
+            header.periodDen = 1000000000;
+            return header;
+        }
+
+        /**
+         *    @brief Convert ticks into nanoseconds.
+         */
+        inline std::int64_t toNanoseconds(std::int64_t ticks) const
+        {
+            if (periodNum == 1 && periodDen == 1000000000)
+                return ticks;
+            return static_cast<std::int64_t>(static_cast<long double>(ticks) * periodNum * 1000000000 / periodDen);
+        }
+    };
+
+
+
+    /**
+     *    @brief The RecordStreamLayout struct defines the binary layout of record streams, all integers being little-endian.
+     *
+     *    A stream is a file header followed by blocks appended one after the other. Each block has a fixed header, with
+     *    its payload size, record count and first and last start ticks, then the records packed as varints: the start
+     *    tick as the zigzag difference from the previous start of the block (from firstStart for the first record), the
+     *    duration in ticks zigzag-encoded and, for events, the name and thread identifiers. Blocks are decoded
+     *    independently, so streams can be appended to and read from any block.
+     *
+     *    Since version 2, anchor blocks may come between record blocks: they have the same header, with AnchorMagic, a
+     *    first and last start tick being the ticks of their first and last anchor, and a payload of 24-byte anchors
+     *    (ticks, wall, uncertainty). Readers of version 1 stop at the first anchor block.
+     */
+    struct RecordStreamLayout {
+        static const std::uint32_t  Version         = 2;            ///< The layout version.
+        static const std::size_t    HeaderSize      = 40;           ///< magic[8], version, kind, clock, reserved, periodNum, periodDen.
+        static const std::size_t    BlockHeaderSize = 32;           ///< magic, payloadSize, count, reserved, firstStart, lastStart.
+        static const std::uint32_t  BlockMagic      = 0x4B424D52u;  ///< "RMBK" in little-endian order.
+        static const std::uint32_t  AnchorMagic     = 0x434E4152u;  ///< "RANC" in little-endian order.
+        static const std::size_t    AnchorSize      = 24;           ///< ticks, wall, uncertainty.
+        static const std::size_t    BlockSize       = 1 << 16;      ///< The payload size after which writers close a block.
+        static const std::size_t    MaxRecordSize   = 4 * 10;       ///< The largest encoded record: four varints of at most 10 bytes.
+
+        /**
+         *    @brief Return the magic of the file header, "PTRECORD".
+         */
+        static const char *Magic()
+        {
+            return "PTRECORD";
+        }
+    };
+
+
+
+    namespace detail {
+
+        template < class Clock >
+        struct RecordClockOf {
+            static const RecordClock value = RecordClock::Unknown;
+        };
+
+        template < >
+        struct RecordClockOf<std::chrono::steady_clock> {
+            static const RecordClock value = RecordClock::Steady;
+        };
+
+        template < >
+        struct RecordClockOf<std::chrono::system_clock> {
+            static const RecordClock value = RecordClock::System;
+        };
+
+#ifdef PROCESS_TIMING_HAS_TSC_CLOCK
+        template < >
+        struct RecordClockOf<TscClock> {
+            static const RecordClock value = RecordClock::Tsc;
+        };
+#endif
+
+        inline void StoreLittle(char *out, std::uint64_t value, std::size_t size)
+        {
+            for (std::size_t i = 0; i < size; ++i)
+                out[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+
+        inline std::uint64_t LoadLittle(const char *in, std::size_t size)
+        {
+            std::uint64_t value = 0;
+            for (std::size_t i = 0; i < size; ++i)
+                value |= static_cast<std::uint64_t>(static_cast<unsigned char>(in[i])) << (8 * i);
+            return value;
+        }
+
+        inline std::uint64_t ZigZag(std::int64_t value)
+        {
+            return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+        }
+
+        inline std::int64_t UnZigZag(std::uint64_t value)
+        {
+            return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+        }
+
+        /**
+         *    @brief Decode a varint, advancing the position; false if it runs past the end or is longer than 10 bytes.
+         */
+        inline bool ReadVarint(const char *&position, const char *end, std::uint64_t &value)
+        {
+            value = 0;
+            for (unsigned shift = 0; shift < 70 && position != end; shift += 7) {
+                std::uint64_t byte = static_cast<unsigned char>(*position++);
+                value |= (byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                    return true;
+            }
+            return false;
+        }
+
+    }
+
+
+
+    template < class Clock >
+    RecordStreamHeader RecordStreamHeader::For(RecordKind kind)
+    {
+        RecordStreamHeader header;
+        header.kind = kind;
+        header.clock = detail::RecordClockOf<Clock>::value;
+        header.periodNum = static_cast<std::int64_t>(Clock::period::num);
+        header.periodDen = static_cast<std::int64_t>(Clock::period::den);
+        return header;
+    }
+
+
+
+    /**
+     *    @brief The RecordStreamWriter class streams timing records or events in the binary record stream format, about
+     *    3 to 6 bytes per record for short sections, buffering a block at a time.
+     *
+     *    It is a consumer for EventRecorder::drain(). Records are best written by increasing start ticks, which keeps the
+     *    deltas small and lets readers seek by time. finish(), or the destructor, writes the last block.
+     */
+    class RecordStreamWriter {
+    public:
+        /**
+         *    @param out The output stream, opened in binary mode; with std::ios::app to append to an existing stream.
+         *    @param header The description of the records.
+         *    @param append If true, the file header is not written, as the stream already has one for the same records.
+         */
+        RecordStreamWriter(std::ostream &out, const RecordStreamHeader &header, bool append = false)
+            : _out(out), _header(header), _count(0), _firstStart(0), _lastStart(0), _total(0), _takeAnchor(nullptr)
+        {
+            _payload.reserve(RecordStreamLayout::BlockSize + RecordStreamLayout::MaxRecordSize);
+            if (!append) {
+                char bytes[RecordStreamLayout::HeaderSize] = {};
+                std::memcpy(bytes, RecordStreamLayout::Magic(), 8);
+                detail::StoreLittle(bytes + 8, RecordStreamLayout::Version, 4);
+                detail::StoreLittle(bytes + 12, static_cast<std::uint32_t>(header.kind), 4);
+                detail::StoreLittle(bytes + 16, static_cast<std::uint32_t>(header.clock), 4);
+                detail::StoreLittle(bytes + 24, static_cast<std::uint64_t>(header.periodNum), 8);
+                detail::StoreLittle(bytes + 32, static_cast<std::uint64_t>(header.periodDen), 8);
+                _out.write(bytes, sizeof(bytes));
+            }
+        }
+
+        RecordStreamWriter(const RecordStreamWriter &) = delete;
+        RecordStreamWriter &operator=(const RecordStreamWriter &) = delete;
+
+        ~RecordStreamWriter()
+        {
+            finish();
+        }
+
+        /**
+         *    @brief Append a record, given its ticks and, for events, its identifiers.
+         */
+        inline void write(std::int64_t start, std::int64_t end, std::uint32_t nameId = 0, std::uint32_t threadId = 0)
+        {
+            if (_count == 0)
+                _firstStart = _lastStart = start;
+            detail::AppendVarint(_payload, detail::ZigZag(start - _lastStart));
+            detail::AppendVarint(_payload, detail::ZigZag(end - start));
+            if (_header.kind == RecordKind::Events) {
+                detail::AppendVarint(_payload, nameId);
+                detail::AppendVarint(_payload, threadId);
+            }
+            _lastStart = start;
+            ++_count;
+            ++_total;
+            if (_payload.size() >= RecordStreamLayout::BlockSize)
+                closeBlock();
+        }
+
+        /**
+         *    @brief Append a timing record.
+         */
+        template < class Clock >
+        inline void write(const BasicTimingRecord<Clock> &record)
+        {
+            write(static_cast<std::int64_t>(record.start.time_since_epoch().count()), static_cast<std::int64_t>(record.end.time_since_epoch().count()));
+        }
+
+        /**
+         *    @brief Append a timing event.
+         */
+        inline void write(const TimingEvent &event)
+        {
+            write(event.start, event.end, event.nameId, event.threadId);
+        }
+
+        inline void operator()(const TimingEvent &event)
+        {
+            write(event);
+        }
+
+        /**
+         *    @brief Write a clock anchor of the ticks of the records, after the current block, which is closed. With
+         *    anchorBlocks() on, closing a non-empty block already writes an anchor, so the given one is not written.
+         */
+        void writeAnchor(const ClockAnchor &anchor)
+        {
+            bool anchored = _count > 0 && _takeAnchor != nullptr;
+            closeBlock();
+            if (!anchored)
+                writeAnchorBlock(anchor);
+        }
+
+        /**
+         *    @brief Write a clock anchor now and after every block, so that readers can map the ticks of the records
+         *    onto the wall clock timeline, correcting the drift of the clock; it costs a few clock reads per block.
+         *    Clock must be the clock of the records.
+         */
+        template < class Clock, class WallClock = std::chrono::system_clock >
+        void anchorBlocks()
+        {
+            _takeAnchor = &TakeAnchor<Clock, WallClock>;
+            writeAnchor(_takeAnchor(_header.kind));
+        }
+
+        /**
+         *    @brief Write the current block, if not empty, and flush the output stream.
+         */
+        inline void finish()
+        {
+            closeBlock();
+            _out.flush();
+        }
+
+        /**
+         *    @brief Return the number of records written.
+         */
+        inline std::uint64_t count() const
+        {
+            return _total;
+        }
+
+    private:
+        using AnchorTaker = ClockAnchor (*)(RecordKind);
+
+        /**
+         *    @brief Take an anchor whose ticks are the ones of the records: nanoseconds for events.
+         */
+        template < class Clock, class WallClock >
+        static ClockAnchor TakeAnchor(RecordKind kind)
+        {
+            ClockAnchor anchor = TakeClockAnchor<Clock, WallClock>();
+            if (kind == RecordKind::Events)
+                anchor.ticks = static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(typename Clock::duration(anchor.ticks)).count());
+            return anchor;
+        }
+
+        void writeAnchorBlock(const ClockAnchor &anchor)
+        {
+            char bytes[RecordStreamLayout::BlockHeaderSize + RecordStreamLayout::AnchorSize] = {};
+            detail::StoreLittle(bytes, RecordStreamLayout::AnchorMagic, 4);
+            detail::StoreLittle(bytes + 4, RecordStreamLayout::AnchorSize, 4);
+            detail::StoreLittle(bytes + 8, 1, 4);
+            detail::StoreLittle(bytes + 16, static_cast<std::uint64_t>(anchor.ticks), 8);
+            detail::StoreLittle(bytes + 24, static_cast<std::uint64_t>(anchor.ticks), 8);
+            char *payload = bytes + RecordStreamLayout::BlockHeaderSize;
+            detail::StoreLittle(payload, static_cast<std::uint64_t>(anchor.ticks), 8);
+            detail::StoreLittle(payload + 8, static_cast<std::uint64_t>(anchor.wall), 8);
+            detail::StoreLittle(payload + 16, static_cast<std::uint64_t>(anchor.uncertainty), 8);
+            _out.write(bytes, sizeof(bytes));
+        }
+
+        void closeBlock()
+        {
+            if (_count == 0)
+                return;
+            char bytes[RecordStreamLayout::BlockHeaderSize] = {};
+            detail::StoreLittle(bytes, RecordStreamLayout::BlockMagic, 4);
+            detail::StoreLittle(bytes + 4, _payload.size(), 4);
+            detail::StoreLittle(bytes + 8, _count, 4);
+            detail::StoreLittle(bytes + 16, static_cast<std::uint64_t>(_firstStart), 8);
+            detail::StoreLittle(bytes + 24, static_cast<std::uint64_t>(_lastStart), 8);
+            _out.write(bytes, sizeof(bytes));
+            _out.write(_payload.data(), static_cast<std::streamsize>(_payload.size()));
+            _payload.clear();
+            _count = 0;
+            if (_takeAnchor != nullptr)
+                writeAnchorBlock(_takeAnchor(_header.kind));
+        }
+
+        std::ostream           &_out;           ///< The output stream.
+        RecordStreamHeader      _header;        ///< The description of the records.
+        std::string             _payload;       ///< The encoded records of the current block.
+        std::uint32_t           _count;         ///< The number of records of the current block.
+        std::int64_t            _firstStart;    ///< The start tick of the first record of the current block.
+        std::int64_t            _lastStart;     ///< The start tick of the last record of the current block.
+        std::uint64_t           _total;         ///< The number of records written.
+        AnchorTaker             _takeAnchor;    ///< Takes the anchor written after every block, if set.
+    };
+
+
+
+    /**
+     *    @brief The RecordBlock struct locates a block of a record stream.
+     */
+    struct RecordBlock {
+        std::size_t     offset;     ///< The offset of the payload in the stream.
+        std::uint32_t   size;       ///< The payload size.
+        std::uint32_t   count;      ///< The number of records.
+        std::int64_t    firstStart; ///< The start tick of the first record.
+        std::int64_t    lastStart;  ///< The start tick of the last record.
+    };
+
+
+
+    /**
+     *    @brief The RecordCursor class decodes the records of a block one at a time, as timing events whose times are
+     *    ticks of the stream clock; records without identifiers have them zero.
+     */
+    class RecordCursor {
+    public:
+        RecordCursor() : _position(nullptr), _end(nullptr), _left(0), _start(0), _events(false) { }
+
+        RecordCursor(const char *payload, const RecordBlock &block, RecordKind kind)
+            : _position(payload), _end(payload + block.size), _left(block.count), _start(block.firstStart), _events(kind == RecordKind::Events) { }
+
+        /**
+         *    @brief Decode the next record.
+         *    @return false at the end of the block, or if the block is corrupted.
+         */
+        bool next(TimingEvent &event)
+        {
+            if (_left == 0)
+                return false;
+            std::uint64_t delta, duration, nameId = 0, threadId = 0;
+            if (!detail::ReadVarint(_position, _end, delta) || !detail::ReadVarint(_position, _end, duration)
+                || (_events && (!detail::ReadVarint(_position, _end, nameId) || !detail::ReadVarint(_position, _end, threadId)))) {
+                _left = 0;
+                return false;
+            }
+            _start += detail::UnZigZag(delta);
+            event.start = _start;
+            event.end = _start + detail::UnZigZag(duration);
+            event.nameId = static_cast<std::uint32_t>(nameId);
+            event.threadId = static_cast<std::uint32_t>(threadId);
+            --_left;
+            return true;
+        }
+
+    private:
+        const char     *_position;  ///< The next byte to decode.
+        const char     *_end;       ///< The end of the payload.
+        std::uint32_t   _left;      ///< The number of records left.
+        std::int64_t    _start;     ///< The start tick of the last decoded record.
+        bool            _events;    ///< Tells if records carry identifiers.
+    };
+
+
+
+    /**
+     *    @brief The RecordStreamReader class reads a record stream in memory, typically memory-mapped: opening scans the
+     *    block headers only, and records are decoded on demand, block by block.
+     *
+     *    A stream whose last block is incomplete, e.g. cut by a crash while appending, is read up to its last complete
+     *    block, and truncated() is true.
+     */
+    class RecordStreamReader {
+    public:
+        /**
+         *    @brief Read a stream held in memory, which must outlive the reader.
+         */
+        RecordStreamReader(const char *data, std::size_t size) : _data(nullptr), _size(0), _mappedSize(0), _mapped(false), _truncated(false)
+        {
+            open(data, size);
+        }
+
+#ifdef PROCESS_TIMING_HAS_RECORD_MAPPING
+        /**
+         *    @brief Memory-map and read a stream file.
+         */
+        explicit RecordStreamReader(const char *path) : _data(nullptr), _size(0), _mappedSize(0), _mapped(false), _truncated(false)
+        {
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0)
+                return;
+            struct stat status;
+            if (::fstat(fd, &status) == 0 && status.st_size > 0) {
+                void *map = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+                if (map != MAP_FAILED) {
+                    _mapped = true;
+                    _mappedSize = static_cast<std::size_t>(status.st_size);
+                    open(static_cast<const char *>(map), _mappedSize);
+                    if (_data == nullptr) {
+                        ::munmap(map, _mappedSize);
+                        _mapped = false;
+                    }
+                }
+            }
+            ::close(fd);
+        }
+#endif
+
+        RecordStreamReader(const RecordStreamReader &) = delete;
+        RecordStreamReader &operator=(const RecordStreamReader &) = delete;
+
+        ~RecordStreamReader()
+        {
+#ifdef PROCESS_TIMING_HAS_RECORD_MAPPING
+            if (_mapped)
+                ::munmap(const_cast<char *>(_data), _mappedSize);
+#endif
+        }
+
+        /**
+         *    @brief Tells if the stream has a valid header.
+         */
+        inline bool isValid() const
+        {
+            return _data != nullptr;
+        }
+
+        /**
+         *    @brief Tells if the stream ends with an incomplete block, which is ignored.
+         */
+        inline bool truncated() const
+        {
+            return _truncated;
+        }
+
+        /**
+         *    @brief Return the description of the records.
+         */
+        inline const RecordStreamHeader &header() const
+        {
+            return _header;
+        }
+
+        /**
+         *    @brief Return the complete blocks of the stream, in order.
+         */
+        inline const std::vector<RecordBlock> &blocks() const
+        {
+            return _blocks;
+        }
+
+        /**
+         *    @brief Return the clock anchors of the stream, in order.
+         */
+        inline const std::vector<ClockAnchor> &anchors() const
+        {
+            return _anchors;
+        }
+
+        /**
+         *    @brief Return the timeline mapping the ticks of the records onto the wall clock of the anchors.
+         */
+        inline ClockTimeline timeline() const
+        {
+            return ClockTimeline(_anchors, _header.periodNum, _header.periodDen);
+        }
+
+        /**
+         *    @brief Return a cursor over the records of a block.
+         */
+        inline RecordCursor cursor(std::size_t block) const
+        {
+            return RecordCursor(_data + _blocks[block].offset, _blocks[block], _header.kind);
+        }
+
+        /**
+         *    @brief Return the index of the first block whose last start tick is not before a tick, or the number of blocks
+         *    if there is none; the stream must have been written by increasing start ticks.
+         */
+        std::size_t seek(std::int64_t tick) const
+        {
+            std::size_t low = 0, high = _blocks.size();
+            while (low < high) {
+                std::size_t middle = low + (high - low) / 2;
+                if (_blocks[middle].lastStart < tick)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+            return low;
+        }
+
+        /**
+         *    @brief Return the total number of records of the complete blocks.
+         */
+        std::uint64_t count() const
+        {
+            std::uint64_t count = 0;
+            for (const RecordBlock &block : _blocks)
+                count += block.count;
+            return count;
+        }
+
+        /**
+         *    @brief Pass every record, in order, to consumer.
+         */
+        template < class Consumer >
+        void forEach(Consumer &&consumer) const
+        {
+            TimingEvent event;
+            for (std::size_t i = 0; i < _blocks.size(); ++i) {
+                RecordCursor records = cursor(i);
+                while (records.next(event))
+                    consumer(static_cast<const TimingEvent &>(event));
+            }
+        }
+
+    private:
+        void open(const char *data, std::size_t size)
+        {
+            if (size < RecordStreamLayout::HeaderSize || std::memcmp(data, RecordStreamLayout::Magic(), 8) != 0)
+                return;
+            std::uint64_t version = detail::LoadLittle(data + 8, 4);
+            if (version < 1 || version > RecordStreamLayout::Version)
+                return;
+            _header.kind = static_cast<RecordKind>(detail::LoadLittle(data + 12, 4));
+            _header.clock = static_cast<RecordClock>(detail::LoadLittle(data + 16, 4));
+            _header.periodNum = static_cast<std::int64_t>(detail::LoadLittle(data + 24, 8));
+            _header.periodDen = static_cast<std::int64_t>(detail::LoadLittle(data + 32, 8));
+            if (_header.periodNum <= 0 || _header.periodDen <= 0)
+                return;
+            std::size_t offset = RecordStreamLayout::HeaderSize;
+            while (offset < size) {
+                std::uint64_t magic = size - offset < RecordStreamLayout::BlockHeaderSize ? 0 : detail::LoadLittle(data + offset, 4);
+                if (magic != RecordStreamLayout::BlockMagic && (magic != RecordStreamLayout::AnchorMagic || version < 2)) {
+                    _truncated = true;
+                    break;
+                }
+                RecordBlock block;
+                block.size = static_cast<std::uint32_t>(detail::LoadLittle(data + offset + 4, 4));
+                block.count = static_cast<std::uint32_t>(detail::LoadLittle(data + offset + 8, 4));
+                block.firstStart = static_cast<std::int64_t>(detail::LoadLittle(data + offset + 16, 8));
+                block.lastStart = static_cast<std::int64_t>(detail::LoadLittle(data + offset + 24, 8));
+                block.offset = offset + RecordStreamLayout::BlockHeaderSize;
+                if (size - block.offset < block.size) {
+                    _truncated = true;
+                    break;
+                }
+                if (magic == RecordStreamLayout::AnchorMagic) {
+                    for (std::size_t i = 0; i + RecordStreamLayout::AnchorSize <= block.size; i += RecordStreamLayout::AnchorSize) {
+                        const char *payload = data + block.offset + i;
+                        ClockAnchor anchor;
+                        anchor.ticks = static_cast<std::int64_t>(detail::LoadLittle(payload, 8));
+                        anchor.wall = static_cast<std::int64_t>(detail::LoadLittle(payload + 8, 8));
+                        anchor.uncertainty = static_cast<std::int64_t>(detail::LoadLittle(payload + 16, 8));
+                        _anchors.push_back(anchor);
+                    }
+                } else {
+                    _blocks.push_back(block);
+                }
+                offset = block.offset + block.size;
+            }
+            _data = data;
+            _size = size;
+        }
+
+        const char                 *_data;          ///< The stream, or nullptr if invalid.
+        std::size_t                 _size;          ///< The size of the stream.
+        std::size_t                 _mappedSize;    ///< The size of the mapping, if mapped.
+        bool                        _mapped;        ///< Tells if the stream is mapped by the reader.
+        bool                        _truncated;     ///< Tells if the stream ends with an incomplete block.
+        RecordStreamHeader          _header;        ///< The description of the records.
+        std::vector<RecordBlock>    _blocks;        ///< The complete record blocks.
+        std::vector<ClockAnchor>    _anchors;       ///< The clock anchors.
+    };
+
+}
+
+#endif // process_timing_record_stream_hpp
@@ -0,0 +1,218 @@
+#ifndef process_timing_sampled_timing_hpp
+#define process_timing_sampled_timing_hpp
+
+#include "platform.hpp"
+#include "scoped_timing.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+namespace timings {
+
+    /**
+     *    @brief SamplingMode tells how the interval between two samples is chosen.
+     */
+    enum class SamplingMode {
+        Fixed,      ///< Every interval-th call is sampled.
+        Geometric   ///< Intervals are random, geometrically distributed with the given mean, so that periodic patterns of calls do not bias the samples.
+    };
+
+
+
+    /**
+     *    @brief The Sampler class decides which calls of a section are timed, counting calls down to the next sample.
+     *
+     *    Each sample carries as weight the number of calls it stands for, i.e. the ones since the previous sample included,
+     *    so that weighted counts and totals are unbiased. A sampler is meant to be used by a single thread, e.g. as a
+     *    thread_local variable: its constructor is constexpr and it is trivially destructible, so such a variable needs
+     *    no initialization guard when constructed from constants.
+     */
+    class Sampler {
+    public:
+        /**
+         *    @brief Create a sampler whose first call is sampled.
+         *    @param interval The number of calls per sample, or its mean in geometric mode; zero is taken as one.
+         */
+        constexpr explicit Sampler(std::uint32_t interval, SamplingMode mode = SamplingMode::Fixed)
+            : _countdown(1), _weight(1), _interval(interval > 0 ? interval : 1), _mode(mode), _random(0) { }
+
+        /**
+         *    @brief Count a call and tell if it is sampled.
+         *    @return The weight of the sample, or zero if the call is not sampled.
+         */
+        inline std::uint32_t sample()
+        {
+            if (--_countdown != 0)
+                return 0;
+            return next();
+        }
+
+        /**
+         *    @brief Return the number of calls per sample, or its mean in geometric mode.
+         */
+        inline std::uint32_t interval() const
+        {
+            return _interval;
+        }
+
+    private:
+        std::uint32_t next()
+        {
+            std::uint32_t weight = _weight;
+            std::uint32_t interval = _interval;
+            if (_mode == SamplingMode::Geometric && interval > 1) {
+                // Inverse transform sampling of the number of trials up to the first success, of probability 1/interval.
+                double uniform = (static_cast<double>(nextRandom() >> 11) + 1.0) * (1.0 / 9007199254740992.0);
+                double trials = std::floor(std::log(uniform) / std::log1p(-1.0 / static_cast<double>(interval))) + 1.0;
+                interval = trials < 4294967295.0 ? static_cast<std::uint32_t>(trials) : 4294967295u;
+            }
+            _countdown = interval;
+            _weight = interval;
+            return weight;
+        }
+
+        std::uint64_t nextRandom()
+        {
+            if (_random == 0) {
+                // Seed from the thread and the object address, with a splitmix64 step.
+                std::uint64_t seed = (static_cast<std::uint64_t>(detail::ThreadIndex()) << 32) ^ reinterpret_cast<std::uintptr_t>(this);
+                seed += 0x9E3779B97F4A7C15ULL;
+                seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+                _random = (seed ^ (seed >> 31)) | 1;
+            }
+            // xorshift64*
+            _random ^= _random >> 12;
+            _random ^= _random << 25;
+            _random ^= _random >> 27;
+            return _random * 0x2545F4914F6CDD1DULL;
+        }
+
+        std::uint32_t   _countdown; ///< The number of calls left up to the next sample.
+        std::uint32_t   _weight;    ///< The weight of the next sample.
+        std::uint32_t   _interval;  ///< The number of calls per sample, or its mean.
+        SamplingMode    _mode;      ///< How intervals are chosen.
+        std::uint64_t   _random;    ///< The state of the random generator of geometric intervals, zero until seeded.
+    };
+
+
+
+    namespace detail {
+
+        template < class Sink, class TimePoint >
+        inline auto RecordWeightedInto(Sink &sink, const TimePoint &start, const TimePoint &end, std::uint64_t weight, int) -> decltype(sink.record(end - start, weight), void())
+        {
+            sink.record(end - start, weight);
+        }
+
+        template < class Sink, class TimePoint >
+        inline void RecordWeightedInto(Sink &sink, const TimePoint &start, const TimePoint &end, std::uint64_t, long)
+        {
+            RecordInto(sink, start, end);
+        }
+
+        /**
+         *    @brief Record a sample into a sink, with its weight if the sink has a record(duration, weight) method.
+         */
+        template < class Sink, class TimePoint >
+        inline void RecordWeightedInto(Sink &sink, const TimePoint &start, const TimePoint &end, std::uint64_t weight)
+        {
+            RecordWeightedInto(sink, start, end, weight, 0);
+        }
+
+    }
+
+
+
+    /**
+     *    @brief The SampledScopedTiming class times its own lifetime only when its sampler samples the call, recording the
+     *    elapsed time with the sample weight into a sink with a record(duration, weight) method, like an accumulating
+     *    timing or a histogram. Sinks without one receive the samples unweighted.
+     *
+     *    A call that is not sampled reads no clock: its cost is the decrement and branch of the sampler.
+     */
+    template < class Sink, class ClockType = std::chrono::steady_clock >
+    class SampledScopedTiming {
+    public:
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+
+        /**
+         *    @brief Start timing if the call is sampled.
+         *    @param sink The sink receiving the elapsed time on destruction; it must outlive this object.
+         *    @param sampler The sampler of the calls of this section.
+         */
+        SampledScopedTiming(Sink &sink, Sampler &sampler) : _sink(sink), _weight(sampler.sample())
+        {
+            if (_weight != 0)
+                _start = Clock::now();
+        }
+
+        SampledScopedTiming(const SampledScopedTiming &) = delete;
+        SampledScopedTiming &operator=(const SampledScopedTiming &) = delete;
+
+        /**
+         *    @brief Stop timing and record the elapsed time, if the call is sampled.
+         */
+        ~SampledScopedTiming()
+        {
+            if (_weight != 0)
+                detail::RecordWeightedInto(_sink, _start, Clock::now(), _weight);
+        }
+
+        /**
+         *    @brief Returns if the call is sampled.
+         */
+        inline bool isSampled() const
+        {
+            return _weight != 0;
+        }
+
+        /**
+         *    @brief Return the weight of the sample, or zero if the call is not sampled.
+         */
+        inline std::uint32_t weight() const
+        {
+            return _weight;
+        }
+
+    private:
+        Sink           &_sink;      ///< The sink receiving the elapsed time.
+        std::uint32_t   _weight;    ///< The weight of the sample, or zero.
+        TimePoint       _start;     ///< The initial time point, if sampled.
+    };
+
+}
+
+
+
+#ifdef __COUNTER__
+    #define PROCESS_TIMING_SAMPLED_SCOPE(sink, interval) \
+        PROCESS_TIMING_SAMPLED_SCOPE_IMPL(sink, interval, ::timings::SamplingMode::Fixed, __COUNTER__)
+    #define PROCESS_TIMING_GEOMETRIC_SCOPE(sink, interval) \
+        PROCESS_TIMING_SAMPLED_SCOPE_IMPL(sink, interval, ::timings::SamplingMode::Geometric, __COUNTER__)
+#else
+    #define PROCESS_TIMING_SAMPLED_SCOPE(sink, interval) \
+        PROCESS_TIMING_SAMPLED_SCOPE_IMPL(sink, interval, ::timings::SamplingMode::Fixed, __LINE__)
+    #define PROCESS_TIMING_GEOMETRIC_SCOPE(sink, interval) \
+        PROCESS_TIMING_SAMPLED_SCOPE_IMPL(sink, interval, ::timings::SamplingMode::Geometric, __LINE__)
+#endif
+
+/**
+ *    @brief PROCESS_TIMING_SAMPLED_SCOPE(sink, interval) times the rest of the enclosing scope into sink once every interval
+ *    executions, per thread; PROCESS_TIMING_GEOMETRIC_SCOPE(sink, interval) does it once every interval executions on
+ *    average, at random. The interval should be a constant expression, so that the per-thread sampler is initialized
+ *    without a guard. When PROCESS_TIMING_DISABLE is defined, they expand to nothing and sink is not evaluated.
+ */
+#ifdef PROCESS_TIMING_DISABLE
+    #define PROCESS_TIMING_SAMPLED_SCOPE_IMPL(sink, interval, mode, unique) static_cast<void>(sizeof(sink))
+#else
+    #define PROCESS_TIMING_SAMPLED_SCOPE_IMPL(sink, interval, mode, unique) \
+        static thread_local ::timings::Sampler PROCESS_TIMING_CONCAT(processTimingSampler, unique)(interval, mode); \
+        ::timings::SampledScopedTiming<typename std::remove_reference<decltype(sink)>::type> \
+            PROCESS_TIMING_CONCAT(processTimingSampled, unique)(sink, PROCESS_TIMING_CONCAT(processTimingSampler, unique))
+#endif
+
+#endif // process_timing_sampled_timing_hpp
@@ -0,0 +1,121 @@
+#ifndef process_timing_scoped_timing_hpp
+#define process_timing_scoped_timing_hpp
+
+#include "process_timing.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace timings {
+
+    /**
+     *    @brief The ScopedTiming class times its own lifetime: it starts on construction and, on destruction, records the
+     *    elapsed time into a sink, i.e. any object with a record(duration) or a record(start, end) method.
+     *
+     *    The sink type is a template parameter, so the call to record() is resolved at compile time and can be inlined:
+     *    with NullSink, the cost is the one of two clock reads.
+     */
+    template < class Sink, class ClockType = std::chrono::steady_clock >
+    class ScopedTiming {
+    public:
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+
+        /**
+         *    @brief Start timing.
+         *    @param sink The sink receiving the elapsed time on destruction; it must outlive this object.
+         */
+        explicit ScopedTiming(Sink &sink) : _sink(sink), _start(Clock::now()) { }
+
+        ScopedTiming(const ScopedTiming &) = delete;
+        ScopedTiming &operator=(const ScopedTiming &) = delete;
+
+        /**
+         *    @brief Stop timing and record the elapsed time, also when the scope is left by an exception.
+         */
+        ~ScopedTiming()
+        {
+            detail::RecordInto(_sink, _start, Clock::now());
+        }
+
+        /**
+         *    @brief Return the initial time point.
+         */
+        inline TimePoint getStartTime() const
+        {
+            return _start;
+        }
+
+    private:
+        Sink           &_sink;  ///< The sink receiving the elapsed time.
+        TimePoint       _start; ///< The initial time point.
+    };
+
+
+
+    /**
+     *    @brief The NullSink struct is a sink discarding every duration.
+     */
+    struct NullSink {
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &) const { }
+
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &, std::uint64_t) const { }
+    };
+
+
+
+    /**
+     *    @brief The CallbackSink class is a sink forwarding every duration to a callable object.
+     */
+    template < class Callback >
+    class CallbackSink {
+    public:
+        explicit CallbackSink(Callback callback) : _callback(std::move(callback)) { }
+
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            _callback(duration);
+        }
+
+    private:
+        Callback    _callback;  ///< The callable object receiving the durations.
+    };
+
+    /**
+     *    @brief Return a sink forwarding every duration to callback.
+     */
+    template < class Callback >
+    inline CallbackSink<Callback> MakeCallbackSink(Callback callback)
+    {
+        return CallbackSink<Callback>(std::move(callback));
+    }
+
+}
+
+
+
+#define PROCESS_TIMING_CONCAT_IMPL(a, b) a##b
+#define PROCESS_TIMING_CONCAT(a, b) PROCESS_TIMING_CONCAT_IMPL(a, b)
+#ifdef __COUNTER__
+    #define PROCESS_TIMING_UNIQUE_NAME(prefix) PROCESS_TIMING_CONCAT(prefix, __COUNTER__)
+#else
+    #define PROCESS_TIMING_UNIQUE_NAME(prefix) PROCESS_TIMING_CONCAT(prefix, __LINE__)
+#endif
+
+/**
+ *    @brief PROCESS_TIMING_SCOPE(sink) times the rest of the enclosing scope into sink.
+ *    When PROCESS_TIMING_DISABLE is defined, it expands to nothing and sink is not evaluated.
+ */
+#ifdef PROCESS_TIMING_DISABLE
+    #define PROCESS_TIMING_SCOPE(sink) static_cast<void>(sizeof(sink))
+#else
+    #define PROCESS_TIMING_SCOPE(sink) \
+        ::timings::ScopedTiming<typename std::remove_reference<decltype(sink)>::type> PROCESS_TIMING_UNIQUE_NAME(processTimingScope)(sink)
+#endif
+
+#endif // process_timing_scoped_timing_hpp
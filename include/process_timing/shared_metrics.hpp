@@ -0,0 +1,447 @@
+#ifndef process_timing_shared_metrics_hpp
+#define process_timing_shared_metrics_hpp
+
+#if defined(__unix__) || defined(__APPLE__)
+    #define PROCESS_TIMING_HAS_SHARED_METRICS 1
+#endif
+
+#ifdef PROCESS_TIMING_HAS_SHARED_METRICS
+
+#include "latency_histogram.hpp"
+#include "platform.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace timings {
+
+    /**
+     *    @brief SharedMetricKind tells how a shared metric is meant to be shown.
+     */
+    enum class SharedMetricKind : std::uint32_t {
+        Accumulator = 1,    ///< Count, total, minimum and maximum.
+        Histogram   = 2     ///< Also the distribution, i.e. its quantiles.
+    };
+
+
+
+    /**
+     *    @brief The SharedMetricsLayout struct defines the fixed layout of a shared metrics file: a header followed by
+     *    slotCount slots of slotSize bytes, all counters being native-endian lock-free atomics.
+     *
+     *    Each slot is a sequence lock: its sequence is odd while it is updated, so that readers retry instead of seeing
+     *    a half-done update. The layout is versioned; readers must check the magic and version before anything else.
+     *
+     *    Lock attempts are bounded, so that a slot left odd by a writer killed while updating it, or a writer stalled
+     *    within an update, never hangs the other writers or the readers: they give up instead.
+     */
+    struct SharedMetricsLayout {
+        static const std::uint32_t  Version         = 1;    ///< The layout version.
+        static const unsigned       Precision       = 3;    ///< The histogram precision of the slots.
+        static const std::size_t    NameCapacity    = 48;   ///< The maximum name length, including the terminating null.
+        static const unsigned       LockAttempts    = 1u << 16; ///< The attempts to take a slot lock, yielding every 64 failed ones.
+
+        using Buckets = HistogramBuckets<Precision>;
+
+        struct alignas(CacheLineSize) Header {
+            char                        magic[8];       ///< "PTMETRIC", written last at creation.
+            std::uint32_t               version;        ///< The layout version.
+            std::uint32_t               headerSize;     ///< The size of the header.
+            std::uint32_t               slotSize;       ///< The size of a slot.
+            std::uint32_t               slotCount;      ///< The number of slots.
+            std::uint32_t               precision;      ///< The histogram precision.
+            std::uint32_t               bucketCount;    ///< The number of buckets of a slot.
+            std::atomic<std::uint32_t>  used;           ///< The number of published slots.
+            std::uint32_t               reserved;       ///< Zero.
+            std::int64_t                created;        ///< The creation time, in nanoseconds since the system clock epoch.
+            std::int64_t                pid;            ///< The identifier of the writing process.
+        };
+
+        struct alignas(CacheLineSize) Slot {
+            std::atomic<std::uint64_t>  sequence;               ///< The sequence lock, odd while updating.
+            std::uint32_t               kind;                   ///< The SharedMetricKind.
+            std::uint32_t               reserved;               ///< Zero.
+            char                        name[NameCapacity];     ///< The null-terminated name.
+            std::atomic<std::uint64_t>  count;                  ///< The number of recorded durations.
+            std::atomic<std::uint64_t>  total;                  ///< The total of the durations, in nanoseconds.
+            std::atomic<std::uint64_t>  min;                    ///< The shortest duration, in nanoseconds; the maximum value if none.
+            std::atomic<std::uint64_t>  max;                    ///< The longest duration, in nanoseconds.
+            std::atomic<std::uint64_t>  buckets[Buckets::Count];    ///< The histogram counts.
+        };
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "shared metrics require lock-free 64 bits atomics");
+
+        /**
+         *    @brief Return the size of a file of the given number of slots.
+         */
+        static constexpr std::size_t FileSize(std::size_t slotCount)
+        {
+            return sizeof(Header) + slotCount * sizeof(Slot);
+        }
+    };
+
+
+
+    /**
+     *    @brief The SharedMetric class is a handle to a slot of a shared metrics file, and a sink: recording takes the
+     *    slot sequence lock, so it may be used by several threads.
+     *
+     *    A default-constructed handle, or one returned by a full file, records nothing. A duration whose slot lock
+     *    cannot be taken within SharedMetricsLayout::LockAttempts attempts is dropped.
+     */
+    class SharedMetric {
+    public:
+        SharedMetric() : _slot(nullptr), _histogram(false) { }
+
+        /**
+         *    @brief Record a duration.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            record(duration, 1);
+        }
+
+        /**
+         *    @brief Record a duration standing for weight durations, e.g. a sample.
+         */
+        template < typename Rep, typename Period >
+        void record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight)
+        {
+            if (_slot == nullptr)
+                return;
+            using Buckets = SharedMetricsLayout::Buckets;
+            std::uint64_t ns = Buckets::Nanoseconds(duration);
+            std::uint64_t sequence;
+            if (!lock(sequence))
+                return;
+            _slot->count.store(_slot->count.load(std::memory_order_relaxed) + weight, std::memory_order_relaxed);
+            _slot->total.store(_slot->total.load(std::memory_order_relaxed) + ns * weight, std::memory_order_relaxed);
+            if (ns < _slot->min.load(std::memory_order_relaxed))
+                _slot->min.store(ns, std::memory_order_relaxed);
+            if (ns > _slot->max.load(std::memory_order_relaxed))
+                _slot->max.store(ns, std::memory_order_relaxed);
+            if (_histogram) {
+                std::atomic<std::uint64_t> &bucket = _slot->buckets[Buckets::Index(ns)];
+                bucket.store(bucket.load(std::memory_order_relaxed) + weight, std::memory_order_relaxed);
+            }
+            _slot->sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        /**
+         *    @brief Tells if the handle refers to a slot.
+         */
+        inline bool isValid() const
+        {
+            return _slot != nullptr;
+        }
+
+    private:
+        friend class SharedMetrics;
+
+        SharedMetric(SharedMetricsLayout::Slot *slot, bool histogram) : _slot(slot), _histogram(histogram) { }
+
+        /**
+         *    @brief Make the sequence odd, waiting for a concurrent writer, and get its previous, even value; return false
+         *    if the lock could not be taken within the bounded attempts.
+         */
+        inline bool lock(std::uint64_t &sequence)
+        {
+            sequence = _slot->sequence.load(std::memory_order_relaxed);
+            for (unsigned attempt = 1; ; ++attempt) {
+                if ((sequence & 1) == 0 &&
+                    _slot->sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    std::atomic_thread_fence(std::memory_order_release);
+                    return true;
+                }
+                if (attempt == SharedMetricsLayout::LockAttempts)
+                    return false;
+                if (attempt % 64 == 0)
+                    std::this_thread::yield();
+                sequence = _slot->sequence.load(std::memory_order_relaxed);
+            }
+        }
+
+        SharedMetricsLayout::Slot  *_slot;      ///< The slot, or nullptr.
+        bool                        _histogram; ///< Tells if the distribution is recorded.
+    };
+
+
+
+    /**
+     *    @brief The SharedMetrics class creates a memory-mapped file of metrics that other processes can read live, with no
+     *    system call and no involvement of the writing process, e.g. with the process_timing_metrics tool.
+     *
+     *    The file is created with a fixed number of slots, under a temporary name renamed into place once initialized,
+     *    so that a file of the same path, e.g. of a previous run, is replaced without disturbing the readers mapping it;
+     *    it is left in place when the object is destroyed.
+     */
+    class SharedMetrics {
+    public:
+        using Layout = SharedMetricsLayout;
+
+        /**
+         *    @brief Create and map the file. On failure, isOpen() is false and every metric records nothing.
+         *    @param path The file path, e.g. in /dev/shm to stay in memory.
+         *    @param slotCount The maximum number of metrics.
+         */
+        explicit SharedMetrics(const std::string &path, std::size_t slotCount = 64) : _header(nullptr), _size(0)
+        {
+            std::string temporary = path + "." + std::to_string(static_cast<long long>(::getpid())) + ".tmp";
+            ::unlink(temporary.c_str());
+            int fd = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+            if (fd < 0)
+                return;
+            std::size_t size = Layout::FileSize(slotCount);
+            void *memory = MAP_FAILED;
+            if (::ftruncate(fd, static_cast<off_t>(size)) == 0)
+                memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (memory == MAP_FAILED) {
+                ::unlink(temporary.c_str());
+                return;
+            }
+
+            Layout::Header *header = static_cast<Layout::Header*>(memory);
+            Initialize(header, slotCount);
+            if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+                ::munmap(memory, size);
+                ::unlink(temporary.c_str());
+                return;
+            }
+            _header = header;
+            _size = size;
+        }
+        SharedMetrics(const SharedMetrics &) = delete;
+        SharedMetrics &operator=(const SharedMetrics &) = delete;
+
+        /**
+         *    @brief Unmap the file; handles must not be used anymore.
+         */
+        ~SharedMetrics()
+        {
+            if (_header != nullptr)
+                ::munmap(_header, _size);
+        }
+
+        /**
+         *    @brief Tells if the file has been created and mapped.
+         */
+        inline bool isOpen() const
+        {
+            return _header != nullptr;
+        }
+
+        /**
+         *    @brief Return the accumulator of the given name, publishing it if needed.
+         */
+        inline SharedMetric accumulator(const std::string &name)
+        {
+            return metric(name, SharedMetricKind::Accumulator);
+        }
+
+        /**
+         *    @brief Return the histogram of the given name, publishing it if needed.
+         */
+        inline SharedMetric histogram(const std::string &name)
+        {
+            return metric(name, SharedMetricKind::Histogram);
+        }
+
+    private:
+        static void Initialize(Layout::Header *header, std::size_t slotCount)
+        {
+            header->version = Layout::Version;
+            header->headerSize = static_cast<std::uint32_t>(sizeof(Layout::Header));
+            header->slotSize = static_cast<std::uint32_t>(sizeof(Layout::Slot));
+            header->slotCount = static_cast<std::uint32_t>(slotCount);
+            header->precision = Layout::Precision;
+            header->bucketCount = static_cast<std::uint32_t>(Layout::Buckets::Count);
+            header->used.store(0, std::memory_order_relaxed);
+            header->created = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+            header->pid = static_cast<std::int64_t>(::getpid());
+            std::atomic_thread_fence(std::memory_order_release);
+            std::memcpy(header->magic, "PTMETRIC", 8);
+        }
+
+        SharedMetric metric(const std::string &name, SharedMetricKind kind)
+        {
+            if (_header == nullptr)
+                return SharedMetric();
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::uint32_t used = _header->used.load(std::memory_order_relaxed);
+            for (std::uint32_t i = 0; i < used; ++i) {
+                Layout::Slot *slot = this->slot(i);
+                if (std::strncmp(slot->name, name.c_str(), Layout::NameCapacity - 1) == 0)
+                    return SharedMetric(slot, slot->kind == static_cast<std::uint32_t>(SharedMetricKind::Histogram));
+            }
+            if (used == _header->slotCount)
+                return SharedMetric();
+            Layout::Slot *slot = this->slot(used);
+            slot->sequence.store(0, std::memory_order_relaxed);
+            slot->kind = static_cast<std::uint32_t>(kind);
+            std::strncpy(slot->name, name.c_str(), Layout::NameCapacity - 1);
+            slot->name[Layout::NameCapacity - 1] = '\0';
+            slot->min.store(~std::uint64_t(0), std::memory_order_relaxed);
+            _header->used.store(used + 1, std::memory_order_release);
+            return SharedMetric(slot, kind == SharedMetricKind::Histogram);
+        }
+
+        inline Layout::Slot *slot(std::uint32_t index) const
+        {
+            return reinterpret_cast<Layout::Slot*>(reinterpret_cast<char*>(_header) + sizeof(Layout::Header) + index * sizeof(Layout::Slot));
+        }
+
+        std::mutex          _mutex;     ///< Serializes the publication of metrics.
+        Layout::Header     *_header;    ///< The mapped file, or nullptr.
+        std::size_t         _size;      ///< The size of the mapping.
+    };
+
+
+
+    /**
+     *    @brief The SharedMetricSnapshot struct holds a consistent copy of a shared metric.
+     */
+    struct SharedMetricSnapshot {
+        using Histogram = HistogramSnapshot<SharedMetricsLayout::Precision>;
+
+        std::string         name;       ///< The metric name.
+        SharedMetricKind    kind;       ///< How the metric is meant to be shown.
+        std::uint64_t       count;      ///< The number of recorded durations.
+        std::uint64_t       total;      ///< The total of the durations, in nanoseconds.
+        std::uint64_t       min;        ///< The shortest duration, in nanoseconds, or zero if none.
+        std::uint64_t       max;        ///< The longest duration, in nanoseconds.
+        Histogram           histogram;  ///< The distribution, for histograms.
+    };
+
+
+
+    /**
+     *    @brief The SharedMetricsReader class maps a shared metrics file read-only and takes consistent snapshots of its
+     *    metrics, with plain memory reads.
+     */
+    class SharedMetricsReader {
+    public:
+        using Layout = SharedMetricsLayout;
+
+        /**
+         *    @brief Map the file. On failure, or if its layout is not supported, isOpen() is false.
+         */
+        explicit SharedMetricsReader(const std::string &path) : _header(nullptr), _size(0)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+                return;
+            struct stat status;
+            void *memory = MAP_FAILED;
+            if (::fstat(fd, &status) == 0 && static_cast<std::size_t>(status.st_size) >= sizeof(Layout::Header))
+                memory = ::mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (memory == MAP_FAILED)
+                return;
+            const Layout::Header *header = static_cast<const Layout::Header*>(memory);
+            bool supported = std::memcmp(header->magic, "PTMETRIC", 8) == 0;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            supported = supported && header->version == Layout::Version && header->headerSize == sizeof(Layout::Header) &&
+                        header->slotSize == sizeof(Layout::Slot) && header->precision == Layout::Precision &&
+                        Layout::FileSize(header->slotCount) <= static_cast<std::size_t>(status.st_size);
+            if (!supported) {
+                ::munmap(memory, static_cast<std::size_t>(status.st_size));
+                return;
+            }
+            _header = header;
+            _size = static_cast<std::size_t>(status.st_size);
+        }
+
+        SharedMetricsReader(const SharedMetricsReader &) = delete;
+        SharedMetricsReader &operator=(const SharedMetricsReader &) = delete;
+
+        ~SharedMetricsReader()
+        {
+            if (_header != nullptr)
+                ::munmap(const_cast<Layout::Header*>(_header), _size);
+        }
+
+        /**
+         *    @brief Tells if the file has been mapped and its layout is supported.
+         */
+        inline bool isOpen() const
+        {
+            return _header != nullptr;
+        }
+
+        /**
+         *    @brief Return the number of published metrics.
+         */
+        inline std::size_t size() const
+        {
+            return _header != nullptr ? _header->used.load(std::memory_order_acquire) : 0;
+        }
+
+        /**
+         *    @brief Return the identifier of the writing process.
+         */
+        inline std::int64_t pid() const
+        {
+            return _header != nullptr ? _header->pid : 0;
+        }
+
+        /**
+         *    @brief Take a consistent snapshot of a published metric, retrying while it is updated, at most
+         *    SharedMetricsLayout::LockAttempts times. Return false if no consistent snapshot could be taken, e.g. because
+         *    the writer was killed while updating the slot: the snapshot then holds a possibly torn copy of the slot.
+         */
+        bool read(std::size_t index, SharedMetricSnapshot &snapshot) const
+        {
+            const Layout::Slot *slot = reinterpret_cast<const Layout::Slot*>(reinterpret_cast<const char*>(_header) + sizeof(Layout::Header) + index * sizeof(Layout::Slot));
+            snapshot.name.assign(slot->name, strnlen(slot->name, Layout::NameCapacity));
+            snapshot.kind = static_cast<SharedMetricKind>(slot->kind);
+            bool histogram = snapshot.kind == SharedMetricKind::Histogram;
+            bool consistent = false;
+            for (unsigned attempt = 1; !consistent && attempt <= Layout::LockAttempts; ++attempt) {
+                if (attempt % 64 == 0)
+                    std::this_thread::yield();
+                std::uint64_t before = slot->sequence.load(std::memory_order_acquire);
+                if ((before & 1) != 0 && attempt < Layout::LockAttempts)
+                    continue;
+                snapshot.count = slot->count.load(std::memory_order_relaxed);
+                snapshot.total = slot->total.load(std::memory_order_relaxed);
+                snapshot.min = slot->min.load(std::memory_order_relaxed);
+                snapshot.max = slot->max.load(std::memory_order_relaxed);
+                snapshot.histogram = SharedMetricSnapshot::Histogram();
+                if (histogram)
+                    for (std::size_t i = 0; i < Layout::Buckets::Count; ++i) {
+                        std::uint64_t count = slot->buckets[i].load(std::memory_order_relaxed);
+                        if (count > 0)
+                            snapshot.histogram.add(i, count);
+                    }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                consistent = (before & 1) == 0 && slot->sequence.load(std::memory_order_relaxed) == before;
+            }
+            if (snapshot.count == 0)
+                snapshot.min = 0;
+            return consistent;
+        }
+
+    private:
+        const Layout::Header   *_header;    ///< The mapped file, or nullptr.
+        std::size_t             _size;      ///< The size of the mapping.
+    };
+
+}
+
+#endif // PROCESS_TIMING_HAS_SHARED_METRICS
+
+#endif // process_timing_shared_metrics_hpp
@@ -0,0 +1,352 @@
+#ifndef process_timing_stage_timing_hpp
+#define process_timing_stage_timing_hpp
+
+#include "latency_histogram.hpp"
+#include "process_timing.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace timings {
+
+    /**
+     *    @brief The BasicStageTiming class times an item through the stages of a pipeline with a single clock read per
+     *    stage transition: the end of a stage is the start of the next one. The Stages + 1 boundary ticks are kept in a
+     *    fixed array.
+     *
+     *    An item is started by start(), or on construction, moved on to the next stage by next(), and completed by
+     *    next() at the last stage or by stop(), which may skip the stages left. Objects are meant to be used by a single
+     *    thread at a time, e.g. along with the item they time.
+     */
+    template < class ClockType, std::size_t Stages >
+    class BasicStageTiming : public ProcessTimingBase {
+    public:
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+        using Duration  = typename Clock::duration;
+
+        static_assert(Stages > 0, "Stages must be positive");
+
+        /**
+         *    @brief Default constructor, starting the first stage.
+         */
+        BasicStageTiming()
+        {
+            start();
+        }
+
+        /**
+         *    @brief Start the first stage, forgetting any previous item.
+         */
+        inline void start()
+        {
+            _ticks[0] = Clock::now().time_since_epoch().count();
+            _taken = 1;
+            _completed = Stages;
+        }
+
+        /**
+         *    @brief End the current stage and start the next one, with one clock read; at the last stage, complete the item.
+         */
+        inline void next()
+        {
+            if (_taken <= Stages)
+                _ticks[_taken++] = Clock::now().time_since_epoch().count();
+        }
+
+        /**
+         *    @brief End the current stage and complete the item, skipping the stages left, if any.
+         */
+        inline void stop()
+        {
+            if (_taken <= Stages) {
+                _ticks[_taken] = Clock::now().time_since_epoch().count();
+                _completed = _taken++;
+                for (; _taken <= Stages; ++_taken)
+                    _ticks[_taken] = _ticks[_completed];
+            }
+        }
+
+        /**
+         *    @brief Complete the item and record the duration of each stage it went through into the sink of the stage,
+         *    i.e. sinks[stage], e.g. an array of histograms or accumulating timings, or a stage breakdown.
+         */
+        template < class Sinks >
+        inline void stop(Sinks &sinks)
+        {
+            stop();
+            record(sinks);
+        }
+
+        /**
+         *    @brief Record the duration of each completed stage into the sink of the stage, i.e. sinks[stage].
+         */
+        template < class Sinks >
+        inline void record(Sinks &sinks) const
+        {
+            std::size_t completed = this->completed();
+            for (std::size_t stage = 0; stage < completed; ++stage)
+                detail::RecordInto(sinks[stage], boundary(stage), boundary(stage + 1));
+        }
+
+        /**
+         *    @brief Returns if a stage is being timed, i.e. the item is not completed.
+         */
+        inline bool isRunning() const
+        {
+            return _taken <= Stages;
+        }
+
+        /**
+         *    @brief Return the index of the current stage, or Stages if the item is completed.
+         */
+        inline std::size_t current() const
+        {
+            return _taken <= Stages ? _taken - 1 : Stages;
+        }
+
+        /**
+         *    @brief Return the number of completed stages, the skipped ones excluded.
+         */
+        inline std::size_t completed() const
+        {
+            return _taken <= Stages ? _taken - 1 : _completed;
+        }
+
+        /**
+         *    @brief Return the time point a stage boundary was crossed at: the start of stage index, or the end of the last
+         *    stage for Stages. Boundaries not crossed yet are undefined.
+         */
+        inline TimePoint boundary(std::size_t index) const
+        {
+            return TimePoint(Duration(_ticks[index]));
+        }
+
+        /**
+         *    @brief Return the duration of a stage: up to now if it is the current one, zero if not reached or skipped.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> stage(std::size_t index) const
+        {
+            Duration duration = Duration::zero();
+            if (index < completed())
+                duration = Duration(_ticks[index + 1] - _ticks[index]);
+            else if (isRunning() && index == current())
+                duration = Clock::now() - boundary(index);
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(duration);
+        }
+
+        /**
+         *    @brief Return the time elapsed since the start of the first stage, up to now if running.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> elapsed() const
+        {
+            TimePoint end = isRunning() ? Clock::now() : boundary(Stages);
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(end - boundary(0));
+        }
+
+        /**
+         *    @brief Return a string representation of the elapsed time.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::string to_string() const
+        {
+            std::string timeStr;
+            TimeToString<Rep,Period>(elapsed<Rep,Period>(), timeStr);
+            return timeStr;
+        }
+
+    private:
+        using Count = typename Duration::rep;
+
+        Count           _ticks[Stages + 1]; ///< The ticks from epoch of the stage boundaries.
+        std::size_t     _taken;             ///< The number of boundaries crossed.
+        std::size_t     _completed;         ///< The number of completed stages, once the item is completed.
+    };
+
+
+
+    /**
+     *    @brief The StageAggregate class aggregates the durations of a pipeline stage across items: their total, lock-free,
+     *    and their distribution, in a latency histogram.
+     */
+    template < unsigned Precision = 5, std::size_t Shards = 1 >
+    class StageAggregate {
+    public:
+        using Histogram = BasicLatencyHistogram<Precision, Shards>;
+
+        StageAggregate() : _total(0) { }
+
+        StageAggregate(const StageAggregate &) = delete;
+        StageAggregate &operator=(const StageAggregate &) = delete;
+
+        /**
+         *    @brief Record a duration.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            _total.fetch_add(Histogram::Buckets::Nanoseconds(duration), std::memory_order_relaxed);
+            _histogram.record(duration);
+        }
+
+        /**
+         *    @brief Record a duration standing for weight durations.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight)
+        {
+            _total.fetch_add(Histogram::Buckets::Nanoseconds(duration) * weight, std::memory_order_relaxed);
+            _histogram.record(duration, weight);
+        }
+
+        /**
+         *    @brief Forget all the recorded durations.
+         */
+        inline void reset()
+        {
+            _total.store(0, std::memory_order_relaxed);
+            _histogram.reset();
+        }
+
+        /**
+         *    @brief Return the total of the recorded durations.
+         */
+        inline std::chrono::nanoseconds total() const
+        {
+            return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(_total.load(std::memory_order_relaxed)));
+        }
+
+        /**
+         *    @brief Return the number of recorded durations.
+         */
+        inline std::uint64_t count() const
+        {
+            return _histogram.count();
+        }
+
+        /**
+         *    @brief Return the average of the recorded durations, or zero if there is none.
+         */
+        inline std::chrono::duration<double,std::nano> mean() const
+        {
+            std::uint64_t count = this->count();
+            return std::chrono::duration<double,std::nano>(count > 0 ? static_cast<double>(_total.load(std::memory_order_relaxed)) / static_cast<double>(count) : 0.0);
+        }
+
+        /**
+         *    @brief Return the value below or at which the given fraction of the recorded durations lies.
+         */
+        inline std::chrono::nanoseconds quantile(double fraction) const
+        {
+            return _histogram.quantile(fraction);
+        }
+
+        /**
+         *    @brief Return the histogram of the recorded durations.
+         */
+        inline const Histogram &histogram() const
+        {
+            return _histogram;
+        }
+
+    private:
+        std::atomic<std::uint64_t>  _total;     ///< The total of the recorded durations, in nanoseconds.
+        Histogram                   _histogram; ///< The distribution of the recorded durations.
+    };
+
+
+
+    /**
+     *    @brief The BasicStageBreakdown class aggregates the stage durations of the items of a pipeline, one StageAggregate
+     *    per stage, to find the bottleneck stage. It is the sinks of BasicStageTiming::stop(sinks); threads may record
+     *    into the same breakdown.
+     */
+    template < std::size_t Stages, unsigned Precision = 5, std::size_t Shards = 1 >
+    class BasicStageBreakdown {
+    public:
+        using Aggregate = StageAggregate<Precision, Shards>;
+
+        static_assert(Stages > 0, "Stages must be positive");
+
+        BasicStageBreakdown() = default;
+
+        BasicStageBreakdown(const BasicStageBreakdown &) = delete;
+        BasicStageBreakdown &operator=(const BasicStageBreakdown &) = delete;
+
+        /**
+         *    @brief Return the aggregate of a stage.
+         */
+        inline Aggregate &operator[](std::size_t stage)
+        {
+            return _stages[stage];
+        }
+
+        inline const Aggregate &operator[](std::size_t stage) const
+        {
+            return _stages[stage];
+        }
+
+        /**
+         *    @brief Return the number of stages.
+         */
+        static constexpr std::size_t size()
+        {
+            return Stages;
+        }
+
+        /**
+         *    @brief Forget all the recorded durations.
+         */
+        inline void reset()
+        {
+            for (std::size_t stage = 0; stage < Stages; ++stage)
+                _stages[stage].reset();
+        }
+
+        /**
+         *    @brief Return the stage with the largest total duration, i.e. the one limiting the throughput of a pipeline
+         *    whose stages run one after the other.
+         */
+        inline std::size_t bottleneck() const
+        {
+            std::size_t bottleneck = 0;
+            for (std::size_t stage = 1; stage < Stages; ++stage)
+                if (_stages[stage].total() > _stages[bottleneck].total())
+                    bottleneck = stage;
+            return bottleneck;
+        }
+
+        /**
+         *    @brief Return the fraction of the total duration of all the stages spent in a stage, or zero if nothing has
+         *    been recorded.
+         */
+        inline double share(std::size_t stage) const
+        {
+            std::chrono::nanoseconds total = std::chrono::nanoseconds::zero();
+            for (std::size_t i = 0; i < Stages; ++i)
+                total += _stages[i].total();
+            return total.count() > 0 ? static_cast<double>(_stages[stage].total().count()) / static_cast<double>(total.count()) : 0.0;
+        }
+
+    private:
+        Aggregate   _stages[Stages];    ///< The aggregates of the stages.
+    };
+
+
+
+    /// The stage timing class, measuring with std::chrono::steady_clock.
+    template < std::size_t Stages >
+    using StageTiming = BasicStageTiming<std::chrono::steady_clock, Stages>;
+
+    /// The default stage breakdown: buckets within 1/32 of their values, 1 shard.
+    template < std::size_t Stages >
+    using StageBreakdown = BasicStageBreakdown<Stages>;
+
+}
+
+#endif // process_timing_stage_timing_hpp
@@ -0,0 +1,399 @@
+#ifndef process_timing_streaming_statistics_hpp
+#define process_timing_streaming_statistics_hpp
+
+#include "latency_histogram.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace timings {
+
+    /**
+     *    @brief The RunningStatistics class keeps the count, mean, variance, minimum and maximum of the durations recorded
+     *    into it, updated in O(1) with Welford's algorithm, so that no sample has to be stored.
+     *
+     *    It is a sink for stop(sink) and scoped timings. Objects are meant to be used by a single thread; per-thread
+     *    objects can be combined with merge().
+     */
+    class RunningStatistics {
+    public:
+        RunningStatistics()
+        {
+            reset();
+        }
+
+        /**
+         *    @brief Forget all the recorded durations.
+         */
+        inline void reset()
+        {
+            _count = 0;
+            _mean = 0.0;
+            _squares = 0.0;
+            _min = std::numeric_limits<std::int64_t>::max();
+            _max = 0;
+        }
+
+        /**
+         *    @brief Record a duration.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            add(Nanoseconds(duration), 1);
+        }
+
+        /**
+         *    @brief Record a duration standing for weight durations, e.g. one sample out of weight timed sections.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight)
+        {
+            if (weight > 0)
+                add(Nanoseconds(duration), weight);
+        }
+
+        /**
+         *    @brief Add the durations recorded by another object, e.g. the one of another thread.
+         */
+        inline void merge(const RunningStatistics &other)
+        {
+            if (other._count == 0)
+                return;
+            if (_count == 0) {
+                *this = other;
+                return;
+            }
+            double n = static_cast<double>(_count);
+            double m = static_cast<double>(other._count);
+            double delta = other._mean - _mean;
+            _count += other._count;
+            _mean += delta * m / (n + m);
+            _squares += other._squares + delta * delta * n * m / (n + m);
+            if (other._min < _min)
+                _min = other._min;
+            if (other._max > _max)
+                _max = other._max;
+        }
+
+        /**
+         *    @brief Return the number of recorded durations.
+         */
+        inline std::uint64_t count() const
+        {
+            return _count;
+        }
+
+        /**
+         *    @brief Return the average of the recorded durations, or zero if there is none.
+         */
+        inline std::chrono::duration<double,std::nano> mean() const
+        {
+            return std::chrono::duration<double,std::nano>(_mean);
+        }
+
+        /**
+         *    @brief Return the population variance of the recorded durations, in squared nanoseconds.
+         */
+        inline double variance() const
+        {
+            return _count > 0 ? _squares / static_cast<double>(_count) : 0.0;
+        }
+
+        /**
+         *    @brief Return the population standard deviation of the recorded durations.
+         */
+        inline std::chrono::duration<double,std::nano> stddev() const
+        {
+            return std::chrono::duration<double,std::nano>(std::sqrt(variance()));
+        }
+
+        /**
+         *    @brief Return the shortest recorded duration, or zero if there is none.
+         */
+        inline std::chrono::nanoseconds min() const
+        {
+            return std::chrono::nanoseconds(_count > 0 ? _min : 0);
+        }
+
+        /**
+         *    @brief Return the longest recorded duration, or zero if there is none.
+         */
+        inline std::chrono::nanoseconds max() const
+        {
+            return std::chrono::nanoseconds(_max);
+        }
+
+    private:
+        template < typename Rep, typename Period >
+        static inline std::int64_t Nanoseconds(const std::chrono::duration<Rep,Period> &duration)
+        {
+            return static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        }
+
+        inline void add(std::int64_t value, std::uint64_t weight)
+        {
+            _count += weight;
+            double delta = static_cast<double>(value) - _mean;
+            _mean += delta * static_cast<double>(weight) / static_cast<double>(_count);
+            _squares += delta * (static_cast<double>(value) - _mean) * static_cast<double>(weight);
+            if (value < _min)
+                _min = value;
+            if (value > _max)
+                _max = value;
+        }
+
+        std::uint64_t   _count;     ///< The number of recorded durations.
+        double          _mean;      ///< The mean of the recorded durations, in nanoseconds.
+        double          _squares;   ///< The sum of the squared deviations from the mean.
+        std::int64_t    _min;       ///< The shortest recorded duration, in nanoseconds.
+        std::int64_t    _max;       ///< The longest recorded duration, in nanoseconds.
+    };
+
+
+
+    /**
+     *    @brief The MovingAverage class keeps an exponentially weighted moving average and variance of the durations
+     *    recorded into it: each duration moves them by a fixed fraction, alpha, so that recent durations weigh the most
+     *    and a latency shift shows within about 1/alpha durations.
+     *
+     *    It is a sink for stop(sink) and scoped timings. Objects are meant to be used by a single thread.
+     */
+    class MovingAverage {
+    public:
+        /**
+         *    @param alpha The weight of each new duration, in (0,1]; values out of range are clamped.
+         */
+        explicit MovingAverage(double alpha) : _keep(1.0 - Clamp(alpha))
+        {
+            reset();
+        }
+
+        /**
+         *    @brief Create a moving average where the weight of a duration halves every given number of later durations.
+         */
+        static inline MovingAverage WithHalfLife(double durations)
+        {
+            return MovingAverage(durations > 0.0 ? 1.0 - std::exp2(-1.0 / durations) : 1.0);
+        }
+
+        /**
+         *    @brief Forget all the recorded durations.
+         */
+        inline void reset()
+        {
+            _count = 0;
+            _mean = 0.0;
+            _variance = 0.0;
+        }
+
+        /**
+         *    @brief Record a duration.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            add(std::chrono::duration<double,std::nano>(duration).count(), _keep, 1);
+        }
+
+        /**
+         *    @brief Record a duration standing for weight durations of the same value.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight)
+        {
+            if (weight > 0)
+                add(std::chrono::duration<double,std::nano>(duration).count(), std::pow(_keep, static_cast<double>(weight)), weight);
+        }
+
+        /**
+         *    @brief Return the number of recorded durations.
+         */
+        inline std::uint64_t count() const
+        {
+            return _count;
+        }
+
+        /**
+         *    @brief Return the weight of each new duration.
+         */
+        inline double alpha() const
+        {
+            return 1.0 - _keep;
+        }
+
+        /**
+         *    @brief Return the moving average, or zero if no duration has been recorded.
+         */
+        inline std::chrono::duration<double,std::nano> mean() const
+        {
+            return std::chrono::duration<double,std::nano>(_mean);
+        }
+
+        /**
+         *    @brief Return the moving variance, in squared nanoseconds.
+         */
+        inline double variance() const
+        {
+            return _variance;
+        }
+
+        /**
+         *    @brief Return the moving standard deviation.
+         */
+        inline std::chrono::duration<double,std::nano> stddev() const
+        {
+            return std::chrono::duration<double,std::nano>(std::sqrt(_variance));
+        }
+
+    private:
+        static inline double Clamp(double alpha)
+        {
+            return alpha > 1.0 ? 1.0 : alpha > 0.0 ? alpha : std::numeric_limits<double>::min();
+        }
+
+        inline void add(double value, double keep, std::uint64_t weight)
+        {
+            // The first duration sets the average, so that it does not start biased toward zero.
+            if (_count == 0) {
+                _mean = value;
+            } else {
+                double delta = value - _mean;
+                _mean += (1.0 - keep) * delta;
+                _variance = keep * (_variance + (1.0 - keep) * delta * delta);
+            }
+            _count += weight;
+        }
+
+        double          _keep;      ///< The weight kept by the average at each new duration, 1 - alpha.
+        std::uint64_t   _count;     ///< The number of recorded durations.
+        double          _mean;      ///< The moving average, in nanoseconds.
+        double          _variance;  ///< The moving variance, in squared nanoseconds.
+    };
+
+
+
+    /**
+     *    @brief The BasicWindowedHistogram class keeps the durations of the last Slots epochs in a ring of latency
+     *    histograms, e.g. ten one-second epochs for the p99 of the last ten seconds, in fixed memory.
+     *
+     *    Durations are recorded, lock-free and in O(1), into the histogram of the current epoch. The epoch is moved on,
+     *    by a single thread, e.g. a control loop, with rotate() or advance(), which clear the histograms of the epochs
+     *    entering the window. Queries merge the histograms of the last epochs, the current one included.
+     */
+    template < unsigned Precision = 5, std::size_t Slots = 10, std::size_t Shards = 1 >
+    class BasicWindowedHistogram {
+    public:
+        using Histogram = BasicLatencyHistogram<Precision, Shards>;
+        using Snapshot  = typename Histogram::Snapshot;
+
+        static_assert(Slots > 0, "Slots must be positive");
+
+        BasicWindowedHistogram() : _epoch(0) { }
+
+        BasicWindowedHistogram(const BasicWindowedHistogram &) = delete;
+        BasicWindowedHistogram &operator=(const BasicWindowedHistogram &) = delete;
+
+        /**
+         *    @brief Record a duration into the current epoch.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            _slots[_epoch.load(std::memory_order_acquire) % Slots].record(duration);
+        }
+
+        /**
+         *    @brief Record a duration standing for weight durations into the current epoch.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight)
+        {
+            _slots[_epoch.load(std::memory_order_acquire) % Slots].record(duration, weight);
+        }
+
+        /**
+         *    @brief Return the current epoch.
+         */
+        inline std::uint64_t epoch() const
+        {
+            return _epoch.load(std::memory_order_relaxed);
+        }
+
+        /**
+         *    @brief Move on to the next epoch, dropping the oldest one.
+         */
+        inline void rotate()
+        {
+            advance(epoch() + 1);
+        }
+
+        /**
+         *    @brief Move on to an epoch, e.g. the time since the clock epoch divided by the epoch duration, dropping the
+         *    epochs that leave the window. Epochs not after the current one are ignored.
+         */
+        inline void advance(std::uint64_t epoch)
+        {
+            std::uint64_t current = this->epoch();
+            if (epoch <= current)
+                return;
+            std::uint64_t steps = epoch - current < Slots ? epoch - current : Slots;
+            for (std::uint64_t step = 1; step <= steps; ++step)
+                _slots[(epoch - steps + step) % Slots].reset();
+            _epoch.store(epoch, std::memory_order_release);
+        }
+
+        /**
+         *    @brief Merge the histograms of the last epochs, the current one included, into a snapshot.
+         *    @param epochs The number of epochs merged, at most Slots.
+         */
+        inline void snapshot(Snapshot &snapshot, std::size_t epochs = Slots) const
+        {
+            std::uint64_t current = epoch();
+            if (epochs > Slots)
+                epochs = Slots;
+            for (std::size_t i = 0; i < epochs && i <= current; ++i)
+                _slots[(current - i) % Slots].snapshot(snapshot);
+        }
+
+        /**
+         *    @brief Return the value below or at which the given fraction of the durations of the last epochs lies.
+         */
+        inline std::chrono::nanoseconds quantile(double fraction, std::size_t epochs = Slots) const
+        {
+            Snapshot merged;
+            snapshot(merged, epochs);
+            return merged.quantile(fraction);
+        }
+
+        /**
+         *    @brief Return the number of durations of the last epochs.
+         */
+        inline std::uint64_t count(std::size_t epochs = Slots) const
+        {
+            std::uint64_t current = epoch();
+            std::uint64_t count = 0;
+            if (epochs > Slots)
+                epochs = Slots;
+            for (std::size_t i = 0; i < epochs && i <= current; ++i)
+                count += _slots[(current - i) % Slots].count();
+            return count;
+        }
+
+    private:
+        std::atomic<std::uint64_t>  _epoch;         ///< The current epoch.
+        Histogram                   _slots[Slots];  ///< The histograms of the last epochs, indexed by epoch modulo Slots.
+    };
+
+
+
+    /// The default windowed histogram: buckets within 1/32 of their values, 10 epochs, 1 shard.
+    using WindowedHistogram = BasicWindowedHistogram<>;
+
+}
+
+#endif // process_timing_streaming_statistics_hpp
@@ -0,0 +1,435 @@
+#ifndef process_timing_timing_registry_hpp
+#define process_timing_timing_registry_hpp
+
+#include "name_registry.hpp"
+#include "platform.hpp"
+#include "process_timing.hpp"
+#include "scoped_timing.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef PROCESS_TIMING_REGISTRY_TIMERS
+    /// The maximum number of distinct timers each thread can register.
+    #define PROCESS_TIMING_REGISTRY_TIMERS 256
+#endif
+
+namespace timings {
+
+    namespace detail {
+
+        /**
+         *    @brief The TimerBank struct holds the aggregates of a timer during one epoch.
+         */
+        struct TimerBank {
+            std::atomic<std::uint64_t>  epoch;  ///< The epoch of the aggregates, written last when the bank is cleared.
+            std::atomic<std::uint64_t>  count;  ///< The number of recorded durations.
+            std::atomic<std::uint64_t>  total;  ///< The sum of the recorded durations, in nanoseconds.
+            std::atomic<std::uint64_t>  min;    ///< The shortest recorded duration, in nanoseconds.
+            std::atomic<std::uint64_t>  max;    ///< The longest recorded duration, in nanoseconds.
+        };
+
+        /**
+         *    @brief The TimerCell struct is a timer of one thread, with one bank per epoch parity, so that the bank of the
+         *    epoch just ended stays readable while the next one is written.
+         */
+        struct TimerCell {
+            std::uint32_t   nameId;     ///< The name identifier of the timer.
+            TimerBank       banks[2];   ///< The aggregates, by epoch parity.
+
+            /**
+             *    @brief Add a duration to the bank of an epoch, clearing it first if it holds an older one. Only the owner
+             *    thread of the cell may call it.
+             */
+            inline void add(std::uint64_t epoch, std::uint64_t nanoseconds, std::uint64_t weight)
+            {
+                TimerBank &bank = banks[epoch & 1];
+                if (bank.epoch.load(std::memory_order_relaxed) != epoch) {
+                    bank.count.store(0, std::memory_order_relaxed);
+                    bank.total.store(0, std::memory_order_relaxed);
+                    bank.min.store(~std::uint64_t(0), std::memory_order_relaxed);
+                    bank.max.store(0, std::memory_order_relaxed);
+                    bank.epoch.store(epoch, std::memory_order_release);
+                }
+                AddRelaxed(bank.total, nanoseconds * weight);
+                if (nanoseconds < bank.min.load(std::memory_order_relaxed))
+                    bank.min.store(nanoseconds, std::memory_order_relaxed);
+                if (nanoseconds > bank.max.load(std::memory_order_relaxed))
+                    bank.max.store(nanoseconds, std::memory_order_relaxed);
+                // The count is published last, so that readers seeing it also see the minimum and maximum it covers.
+                bank.count.store(bank.count.load(std::memory_order_relaxed) + weight, std::memory_order_release);
+            }
+        };
+
+        /**
+         *    @brief The TimerShard class holds the timers registered by one thread.
+         *
+         *    Only the owner thread registers and writes timers; other threads may read the published cells at any time.
+         */
+        class TimerShard {
+        public:
+            static const std::uint32_t  Capacity    = PROCESS_TIMING_REGISTRY_TIMERS;  ///< The maximum number of cells.
+            static const std::uint32_t  Overflow    = 0;    ///< The index of the cell collecting the timers beyond capacity.
+
+            TimerShard() : next(nullptr), owned(true), _size(0)
+            {
+                create(NameRegistry::Overflow);
+            }
+
+            TimerShard(const TimerShard &) = delete;
+            TimerShard &operator=(const TimerShard &) = delete;
+
+            /**
+             *    @brief Return the cell of a timer, creating it if needed.
+             */
+            TimerCell &find(std::uint32_t nameId)
+            {
+                std::uint32_t size = _size.load(std::memory_order_relaxed);
+                for (std::uint32_t i = Overflow + 1; i < size; ++i)
+                    if (_cells[i].nameId == nameId)
+                        return _cells[i];
+                return _cells[create(nameId)];
+            }
+
+            /**
+             *    @brief Return the number of published cells.
+             */
+            inline std::uint32_t size() const
+            {
+                return _size.load(std::memory_order_acquire);
+            }
+
+            /**
+             *    @brief Return a published cell.
+             */
+            inline const TimerCell &cell(std::uint32_t index) const
+            {
+                return _cells[index];
+            }
+
+            TimerShard         *next;   ///< The next shard of the registry list.
+            std::atomic<bool>   owned;  ///< Tells if a thread records into the shard.
+
+        private:
+            std::uint32_t create(std::uint32_t nameId)
+            {
+                std::uint32_t index = _size.load(std::memory_order_relaxed);
+                if (index == Capacity)
+                    return Overflow;
+                TimerCell &cell = _cells[index];
+                cell.nameId = nameId;
+                for (TimerBank &bank : cell.banks) {
+                    // No epoch is ~0, so that the first add() clears the bank.
+                    bank.epoch.store(~std::uint64_t(0), std::memory_order_relaxed);
+                    bank.count.store(0, std::memory_order_relaxed);
+                    bank.total.store(0, std::memory_order_relaxed);
+                    bank.min.store(~std::uint64_t(0), std::memory_order_relaxed);
+                    bank.max.store(0, std::memory_order_relaxed);
+                }
+                _size.store(index + 1, std::memory_order_release);
+                return index;
+            }
+
+            TimerCell                   _cells[Capacity];   ///< The timers; cell 0 collects the ones beyond capacity.
+            std::atomic<std::uint32_t>  _size;              ///< The number of published cells.
+        };
+
+    }
+
+
+
+    /**
+     *    @brief The RegisteredTimer class is a handle to a timer of the registry, owned by the thread that registered it.
+     *
+     *    It is a sink, with record(duration) and record(duration, weight) methods, for stop(sink), scoped and sampled
+     *    timings. Recording reads the registry epoch and updates the aggregates of the thread with relaxed stores only;
+     *    it must be done by the registering thread.
+     */
+    class RegisteredTimer {
+    public:
+        RegisteredTimer(detail::TimerCell &cell, const std::atomic<std::uint64_t> &epoch) : _cell(&cell), _epoch(&epoch) { }
+
+        /**
+         *    @brief Record a duration.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration)
+        {
+            record(duration, 1);
+        }
+
+        /**
+         *    @brief Record a duration standing for weight durations of the same length, e.g. one sample out of weight timed
+         *    sections.
+         */
+        template < typename Rep, typename Period >
+        inline void record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight)
+        {
+            std::chrono::nanoseconds::rep nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            _cell->add(_epoch->load(std::memory_order_relaxed), nanoseconds > 0 ? static_cast<std::uint64_t>(nanoseconds) : 0, weight);
+        }
+
+        /**
+         *    @brief Return the name identifier of the timer, NameRegistry::Overflow if the thread has too many timers.
+         */
+        inline std::uint32_t nameId() const
+        {
+            return _cell->nameId;
+        }
+
+    private:
+        detail::TimerCell                  *_cell;  ///< The cell of the timer, in the shard of the owner thread.
+        const std::atomic<std::uint64_t>   *_epoch; ///< The epoch of the registry.
+    };
+
+
+
+    /**
+     *    @brief The TimerStats struct holds the aggregates of a timer, merged across threads. While threads record, the
+     *    aggregates are read independently of each other, so the total may include durations the count does not, and
+     *    mean() is approximate.
+     */
+    struct TimerStats {
+        std::uint32_t               nameId; ///< The name identifier of the timer.
+        std::uint64_t               count;  ///< The number of recorded durations.
+        std::chrono::nanoseconds    total;  ///< The sum of the recorded durations.
+        std::chrono::nanoseconds    min;    ///< The shortest recorded duration, or zero if there is none.
+        std::chrono::nanoseconds    max;    ///< The longest recorded duration.
+
+        /**
+         *    @brief Return the average recorded duration, or zero if there is none; approximate while threads record.
+         */
+        inline std::chrono::nanoseconds mean() const
+        {
+            return count > 0 ? total / static_cast<std::chrono::nanoseconds::rep>(count) : std::chrono::nanoseconds::zero();
+        }
+    };
+
+
+
+    /**
+     *    @brief The TimingRegistrySnapshot class holds the timers of an epoch merged across threads, by name identifier.
+     */
+    class TimingRegistrySnapshot {
+    public:
+        std::uint64_t           epoch;  ///< The epoch of the aggregates.
+        std::vector<TimerStats> timers; ///< The timers with at least one recorded duration, by increasing name identifier.
+
+        /**
+         *    @brief Return the timer of a name identifier, or nullptr if it has no recorded duration.
+         */
+        const TimerStats *find(std::uint32_t nameId) const
+        {
+            for (const TimerStats &stats : timers)
+                if (stats.nameId == nameId)
+                    return &stats;
+            return nullptr;
+        }
+
+        /**
+         *    @brief Write the timers as text, one per line, with their count, total, mean, minimum and maximum.
+         */
+        void write(std::ostream &out, const NameRegistry &names = NameRegistry::Global()) const
+        {
+            std::string total, mean, min, max;
+            for (const TimerStats &stats : timers) {
+                const char *name = names.name(stats.nameId);
+                ProcessTimingBase::TimeToString(stats.total, total);
+                ProcessTimingBase::TimeToString(stats.mean(), mean);
+                ProcessTimingBase::TimeToString(stats.min, min);
+                ProcessTimingBase::TimeToString(stats.max, max);
+                out << (name != nullptr ? name : "<overflow>") << "  count=" << stats.count << "  total=" << total
+                    << "  mean=" << mean << "  min=" << min << "  max=" << max << '\n';
+            }
+        }
+    };
+
+
+
+    /**
+     *    @brief The TimingRegistry class aggregates named timers that threads register into their own shards, e.g. the
+     *    same phases timed by every worker.
+     *
+     *    Registration is lock-free but scans the shard of the thread, so it is meant to be done once, e.g. into a
+     *    thread_local variable. snapshot() merges the shards of all threads without blocking them; reset() starts a new
+     *    epoch with a single atomic increment, after which each thread clears its timers as it next records into them,
+     *    and returns the aggregates of the epoch just ended.
+     */
+    class TimingRegistry {
+    public:
+        TimingRegistry() : _shards(nullptr), _epoch(0) { }
+
+        TimingRegistry(const TimingRegistry &) = delete;
+        TimingRegistry &operator=(const TimingRegistry &) = delete;
+
+        /**
+         *    @brief Return the process-wide registry. It is never destroyed.
+         */
+        static TimingRegistry &Global()
+        {
+            static TimingRegistry *registry = detail::NewPermanent<TimingRegistry>();
+            return *registry;
+        }
+
+        /**
+         *    @brief Return the shard of the calling thread, taking it from the global registry at the first call.
+         */
+        static detail::TimerShard &Local()
+        {
+            thread_local ThreadShard local(Global().acquire());
+            return *local.shard;
+        }
+
+        /**
+         *    @brief Register a timer of the calling thread into the global registry.
+         *    @param nameId The name identifier of the timer, as returned by NameRegistry::intern().
+         */
+        static RegisteredTimer Register(std::uint32_t nameId)
+        {
+            return RegisteredTimer(Local().find(nameId), Global()._epoch);
+        }
+
+        /**
+         *    @brief Register a timer of the calling thread into the global registry, interning its name.
+         */
+        static RegisteredTimer Register(const char *name)
+        {
+            return Register(NameRegistry::Global().intern(name));
+        }
+
+        /**
+         *    @brief Return the current epoch, i.e. the number of resets.
+         */
+        inline std::uint64_t epoch() const
+        {
+            return _epoch.load(std::memory_order_acquire);
+        }
+
+        /**
+         *    @brief Merge the timers of all threads recorded during the current epoch.
+         */
+        TimingRegistrySnapshot snapshot() const
+        {
+            return collect(epoch());
+        }
+
+        /**
+         *    @brief Start a new epoch and return the timers recorded during the one just ended. Durations recorded by
+         *    threads while the epoch changes may be accounted in either.
+         */
+        TimingRegistrySnapshot reset()
+        {
+            return collect(_epoch.fetch_add(1, std::memory_order_acq_rel));
+        }
+
+    private:
+        struct ThreadShard {
+            explicit ThreadShard(detail::TimerShard *acquired) : shard(acquired) { }
+
+            ~ThreadShard()
+            {
+                shard->owned.store(false, std::memory_order_release);
+            }
+
+            detail::TimerShard *shard;  ///< The shard of the thread.
+        };
+
+        detail::TimerShard *acquire()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (detail::TimerShard *shard = _shards; shard != nullptr; shard = shard->next) {
+                bool owned = false;
+                if (shard->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+                    return shard;
+            }
+            detail::TimerShard *shard = detail::NewPermanent<detail::TimerShard>();
+            shard->next = _shards;
+            _shards = shard;
+            return shard;
+        }
+
+        TimingRegistrySnapshot collect(std::uint64_t epoch) const
+        {
+            TimingRegistrySnapshot snapshot;
+            snapshot.epoch = epoch;
+            std::map<std::uint32_t, TimerStats> merged;
+            std::map<std::uint32_t, std::pair<std::uint64_t, std::uint64_t>> extremes;
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (const detail::TimerShard *shard = _shards; shard != nullptr; shard = shard->next) {
+                std::uint32_t size = shard->size();
+                for (std::uint32_t i = 0; i < size; ++i) {
+                    const detail::TimerCell &cell = shard->cell(i);
+                    const detail::TimerBank &bank = cell.banks[epoch & 1];
+                    if (bank.epoch.load(std::memory_order_acquire) != epoch)
+                        continue;
+                    std::uint64_t count = bank.count.load(std::memory_order_acquire);
+                    if (count == 0)
+                        continue;
+                    std::chrono::nanoseconds total(static_cast<std::chrono::nanoseconds::rep>(bank.total.load(std::memory_order_relaxed)));
+                    // Merged unsigned, so that the empty bank values, ~0 and 0, never win even if read along a new count.
+                    std::uint64_t min = bank.min.load(std::memory_order_relaxed);
+                    std::uint64_t max = bank.max.load(std::memory_order_relaxed);
+                    auto it = merged.find(cell.nameId);
+                    if (it == merged.end()) {
+                        TimerStats stats = { cell.nameId, count, total, std::chrono::nanoseconds::zero(), std::chrono::nanoseconds::zero() };
+                        merged.insert(std::make_pair(cell.nameId, stats));
+                        extremes.insert(std::make_pair(cell.nameId, std::make_pair(min, max)));
+                        continue;
+                    }
+                    TimerStats &stats = it->second;
+                    stats.count += count;
+                    stats.total += total;
+                    std::pair<std::uint64_t, std::uint64_t> &extreme = extremes[cell.nameId];
+                    if (min < extreme.first)
+                        extreme.first = min;
+                    if (max > extreme.second)
+                        extreme.second = max;
+                }
+            }
+            snapshot.timers.reserve(merged.size());
+            for (auto &entry : merged) {
+                const std::pair<std::uint64_t, std::uint64_t> &extreme = extremes[entry.first];
+                entry.second.min = std::chrono::nanoseconds(extreme.first != ~std::uint64_t(0) ? static_cast<std::chrono::nanoseconds::rep>(extreme.first) : 0);
+                entry.second.max = std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(extreme.second));
+                snapshot.timers.push_back(entry.second);
+            }
+            return snapshot;
+        }
+
+        mutable std::mutex          _mutex;     ///< Protects the list of shards.
+        detail::TimerShard         *_shards;    ///< The list of shards, grown at its head.
+        std::atomic<std::uint64_t>  _epoch;     ///< The current epoch.
+    };
+
+}
+
+
+
+#ifdef __COUNTER__
+    #define PROCESS_TIMING_REGISTERED_SCOPE(name) PROCESS_TIMING_REGISTERED_SCOPE_IMPL(name, __COUNTER__)
+#else
+    #define PROCESS_TIMING_REGISTERED_SCOPE(name) PROCESS_TIMING_REGISTERED_SCOPE_IMPL(name, __LINE__)
+#endif
+
+/**
+ *    @brief PROCESS_TIMING_REGISTERED_SCOPE(name) times the rest of the enclosing scope into the timer of the calling thread
+ *    named name, in the global registry; the timer is registered once per thread, at its first execution. When
+ *    PROCESS_TIMING_DISABLE is defined, it expands to nothing.
+ */
+#ifdef PROCESS_TIMING_DISABLE
+    #define PROCESS_TIMING_REGISTERED_SCOPE_IMPL(name, unique) static_cast<void>(0)
+#else
+    #define PROCESS_TIMING_REGISTERED_SCOPE_IMPL(name, unique) \
+        static thread_local ::timings::RegisteredTimer PROCESS_TIMING_CONCAT(processTimingTimer, unique) = ::timings::TimingRegistry::Register(name); \
+        ::timings::ScopedTiming< ::timings::RegisteredTimer> PROCESS_TIMING_CONCAT(processTimingScope, unique)(PROCESS_TIMING_CONCAT(processTimingTimer, unique))
+#endif
+
+#endif // process_timing_timing_registry_hpp
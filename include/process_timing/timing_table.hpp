@@ -0,0 +1,178 @@
+#ifndef process_timing_timing_table_hpp
+#define process_timing_timing_table_hpp
+
+#include "process_timing.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace timings {
+
+    /**
+     *    @brief The BasicTimingTable class stores many timings as a structure of arrays: the start and end ticks of all the
+     *    slots are kept in two contiguous arrays, which batch analyses can scan directly.
+     *
+     *    Slots are claimed by acquire() and given back by release(), which are thread-safe; a slot is then timed by its
+     *    owner only. The tick arrays are read without synchronization, so they must be read while the owners are not
+     *    writing them, e.g. after joining the owner threads. Owners writing neighbouring slots share cache lines: for
+     *    timings written concurrently by many threads, prefer padded timings.
+     */
+    template < class ClockType >
+    class BasicTimingTable {
+    public:
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+        using Duration  = typename TimePoint::duration;
+        using Count     = typename Duration::rep;
+
+        static const std::size_t Invalid = static_cast<std::size_t>(-1);  ///< The slot returned when the table is full.
+
+        /**
+         *    @brief Create a table of the given number of slots, all free.
+         */
+        explicit BasicTimingTable(std::size_t capacity)
+            : _starts(capacity, Count()), _ends(capacity, Count()), _flags(new std::atomic<std::uint8_t>[capacity]),
+              _capacity(capacity), _next(0)
+        {
+            for (std::size_t slot = 0; slot < capacity; ++slot)
+                _flags[slot].store(0, std::memory_order_relaxed);
+        }
+
+        BasicTimingTable(const BasicTimingTable &) = delete;
+        BasicTimingTable &operator=(const BasicTimingTable &) = delete;
+
+        /**
+         *    @brief Claim a free slot, whose timing is not running and zero, or return Invalid if there is none.
+         */
+        std::size_t acquire()
+        {
+            std::size_t first = _next.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < _capacity; ++i) {
+                std::size_t slot = (first + i) % _capacity;
+                std::uint8_t expected = 0;
+                if (_flags[slot].load(std::memory_order_relaxed) == 0 &&
+                    _flags[slot].compare_exchange_strong(expected, Owned, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    _next.store(slot + 1 == _capacity ? 0 : slot + 1, std::memory_order_relaxed);
+                    _starts[slot] = Count();
+                    _ends[slot] = Count();
+                    return slot;
+                }
+            }
+            return Invalid;
+        }
+
+        /**
+         *    @brief Give back an acquired slot.
+         */
+        inline void release(std::size_t slot)
+        {
+            _flags[slot].store(0, std::memory_order_release);
+        }
+
+        /**
+         *    @brief Tell if a slot is acquired.
+         */
+        inline bool owned(std::size_t slot) const
+        {
+            return (_flags[slot].load(std::memory_order_acquire) & Owned) != 0;
+        }
+
+        /**
+         *    @brief Initialize the counter of a slot.
+         */
+        inline void start(std::size_t slot)
+        {
+            _starts[slot] = Clock::now().time_since_epoch().count();
+            _flags[slot].store(Owned | Ongoing, std::memory_order_release);
+        }
+
+        /**
+         *    @brief Terminate the counter of a slot.
+         */
+        inline void stop(std::size_t slot)
+        {
+            _ends[slot] = Clock::now().time_since_epoch().count();
+            _flags[slot].store(Owned, std::memory_order_release);
+        }
+
+        /**
+         *    @brief Returns if the counter of a slot is counting or not.
+         */
+        inline bool isRunning(std::size_t slot) const
+        {
+            return (_flags[slot].load(std::memory_order_acquire) & Ongoing) != 0;
+        }
+
+        /**
+         *    @brief Return the initial time point of a slot.
+         */
+        inline TimePoint getStartTime(std::size_t slot) const
+        {
+            return TimePoint(Duration(_starts[slot]));
+        }
+
+        /**
+         *    @brief Return the final time point of a slot, or now if it is running.
+         */
+        inline TimePoint getEndTime(std::size_t slot) const
+        {
+            return isRunning(slot) ? Clock::now() : TimePoint(Duration(_ends[slot]));
+        }
+
+        /**
+         *    @brief Return how much time has been elapsed since the start of a slot.
+         */
+        template < typename Rep = std::chrono::nanoseconds::rep, typename Period = std::chrono::nanoseconds::period >
+        inline std::chrono::duration<Rep,Period> elapsed(std::size_t slot) const
+        {
+            return std::chrono::duration_cast<std::chrono::duration<Rep,Period>>(getEndTime(slot) - getStartTime(slot));
+        }
+
+        /**
+         *    @brief Return the number of slots.
+         */
+        inline std::size_t capacity() const
+        {
+            return _capacity;
+        }
+
+        /**
+         *    @brief Return the start ticks of all the slots, in Clock::duration units from the clock epoch.
+         */
+        inline const Count *starts() const
+        {
+            return _starts.data();
+        }
+
+        /**
+         *    @brief Return the end ticks of all the slots, in Clock::duration units from the clock epoch. The end tick of a
+         *    running slot is the one of its previous stop.
+         */
+        inline const Count *ends() const
+        {
+            return _ends.data();
+        }
+
+    private:
+        static const std::uint8_t Owned     = 1;    ///< The flag bit telling that a slot is acquired.
+        static const std::uint8_t Ongoing   = 2;    ///< The flag bit telling that the counter of a slot is counting.
+
+        std::vector<Count>                              _starts;    ///< The start ticks by slot.
+        std::vector<Count>                              _ends;      ///< The end ticks by slot.
+        std::unique_ptr<std::atomic<std::uint8_t>[]>    _flags;     ///< The ownership and counting flags by slot.
+        std::size_t                                     _capacity;  ///< The number of slots.
+        std::atomic<std::size_t>                        _next;      ///< The slot where the search for a free one begins.
+    };
+
+
+
+    /// The timing table class, measuring with std::chrono::steady_clock.
+    using TimingTable = BasicTimingTable<std::chrono::steady_clock>;
+
+}
+
+#endif // process_timing_timing_table_hpp
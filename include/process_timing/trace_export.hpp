@@ -0,0 +1,461 @@
+#ifndef process_timing_trace_export_hpp
+#define process_timing_trace_export_hpp
+
+#include "clock_anchor.hpp"
+#include "event_recorder.hpp"
+#include "name_registry.hpp"
+#include "process_timing.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace timings {
+
+    /**
+     *    @brief NameResolver returns the name of a section from its identifier.
+     */
+    using NameResolver = std::function<std::string(std::uint32_t)>;
+
+
+
+    namespace detail {
+
+        /**
+         *    @brief The TraceOutput class buffers bytes and writes them to a stream in large chunks.
+         */
+        class TraceOutput {
+        public:
+            static const std::size_t ChunkSize = 1 << 16;   ///< The size of the chunks written to the stream.
+
+            explicit TraceOutput(std::ostream &out) : _out(out), _size(0), _buffer(ChunkSize) { }
+
+            TraceOutput(const TraceOutput &) = delete;
+            TraceOutput &operator=(const TraceOutput &) = delete;
+
+            ~TraceOutput()
+            {
+                flush();
+            }
+
+            inline void put(char c)
+            {
+                if (_size == ChunkSize)
+                    flush();
+                _buffer[_size++] = c;
+            }
+
+            inline void write(const char *data, std::size_t size)
+            {
+                if (_size + size > ChunkSize) {
+                    flush();
+                    if (size > ChunkSize) {
+                        _out.write(data, static_cast<std::streamsize>(size));
+                        return;
+                    }
+                }
+                for (std::size_t i = 0; i < size; ++i)
+                    _buffer[_size + i] = data[i];
+                _size += size;
+            }
+
+            inline void write(const std::string &data)
+            {
+                write(data.data(), data.size());
+            }
+
+            /**
+             *    @brief Append an integer, left-padded with '0' up to width characters.
+             */
+            template < typename Int >
+            inline void integer(Int value, std::size_t width = 0)
+            {
+                if (_size + 32 > ChunkSize)
+                    flush();
+                CharWriter writer(&_buffer[_size], ChunkSize - _size);
+                writer.integer(value, width);
+                _size += writer.length();
+            }
+
+            inline void flush()
+            {
+                if (_size > 0)
+                    _out.write(&_buffer[0], static_cast<std::streamsize>(_size));
+                _size = 0;
+            }
+
+        private:
+            std::ostream       &_out;       ///< The output stream.
+            std::size_t         _size;      ///< The number of buffered bytes.
+            std::vector<char>   _buffer;    ///< The buffered bytes.
+        };
+
+        /**
+         *    @brief Return a name resolver giving the decimal identifier as name.
+         */
+        inline NameResolver NumericNames()
+        {
+            return [](std::uint32_t nameId) { return std::to_string(nameId); };
+        }
+
+        /**
+         *    @brief Return a name resolver looking names up in the global registry, falling back to the decimal identifier.
+         */
+        inline NameResolver RegisteredNames()
+        {
+            return [](std::uint32_t nameId) {
+                const char *name = NameRegistry::Global().name(nameId);
+                return name != nullptr ? std::string(name) : std::to_string(nameId);
+            };
+        }
+
+        /**
+         *    @brief Append a protobuf varint to a string.
+         */
+        inline void AppendVarint(std::string &out, std::uint64_t value)
+        {
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        /**
+         *    @brief Append a protobuf varint field to a string.
+         */
+        inline void AppendVarintField(std::string &out, std::uint32_t field, std::uint64_t value)
+        {
+            AppendVarint(out, static_cast<std::uint64_t>(field) << 3);
+            AppendVarint(out, value);
+        }
+
+        /**
+         *    @brief Append a protobuf length-delimited field (string, bytes or nested message) to a string.
+         */
+        inline void AppendBytesField(std::string &out, std::uint32_t field, const std::string &bytes)
+        {
+            AppendVarint(out, (static_cast<std::uint64_t>(field) << 3) | 2);
+            AppendVarint(out, bytes.size());
+            out.append(bytes);
+        }
+
+    }
+
+
+
+    /**
+     *    @brief The ChromeTraceWriter class streams timing events as Chrome Trace Event Format JSON ("X" complete events),
+     *    readable by chrome://tracing and ui.perfetto.dev.
+     *
+     *    Output is written in chunks while events arrive, so the document is never held in memory. The writer is a consumer
+     *    for EventRecorder::drain().
+     */
+    class ChromeTraceWriter {
+    public:
+        /**
+         *    @brief Begin the document.
+         *    @param out The output stream; it must outlive the writer.
+         *    @param names The resolver of the section names, called once per identifier.
+         *    @param pid The process identifier written into the events.
+         */
+        explicit ChromeTraceWriter(std::ostream &out, NameResolver names = detail::RegisteredNames(), std::uint32_t pid = 0)
+            : _out(out), _names(std::move(names)), _pid(pid), _first(true), _finished(false)
+        {
+            static const char header[] = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+            _out.write(header, sizeof(header) - 1);
+        }
+
+        ChromeTraceWriter(const ChromeTraceWriter &) = delete;
+        ChromeTraceWriter &operator=(const ChromeTraceWriter &) = delete;
+
+        ~ChromeTraceWriter()
+        {
+            finish();
+        }
+
+        /**
+         *    @brief Append an event.
+         */
+        inline void write(const TimingEvent &event)
+        {
+            if (!_first)
+                _out.write(",\n", 2);
+            _first = false;
+            static const char name[] = "{\"ph\":\"X\",\"name\":\"";
+            _out.write(name, sizeof(name) - 1);
+            _out.write(escapedName(event.nameId));
+            static const char pid[] = "\",\"pid\":";
+            _out.write(pid, sizeof(pid) - 1);
+            _out.integer(_pid);
+            static const char tid[] = ",\"tid\":";
+            _out.write(tid, sizeof(tid) - 1);
+            _out.integer(event.threadId);
+            static const char ts[] = ",\"ts\":";
+            _out.write(ts, sizeof(ts) - 1);
+            microseconds(event.start);
+            static const char dur[] = ",\"dur\":";
+            _out.write(dur, sizeof(dur) - 1);
+            microseconds(event.end - event.start);
+            _out.put('}');
+        }
+
+        inline void operator()(const TimingEvent &event)
+        {
+            write(event);
+        }
+
+        /**
+         *    @brief Append a clock anchor of the event ticks, as a "clock_anchor" metadata event whose arguments are the
+         *    anchor fields, in nanoseconds, so that traces of different hosts can be aligned; viewers ignore it.
+         */
+        inline void writeAnchor(const ClockAnchor &anchor)
+        {
+            if (!_first)
+                _out.write(",\n", 2);
+            _first = false;
+            static const char name[] = "{\"ph\":\"M\",\"name\":\"clock_anchor\",\"pid\":";
+            _out.write(name, sizeof(name) - 1);
+            _out.integer(_pid);
+            static const char ticks[] = ",\"args\":{\"ticks\":";
+            _out.write(ticks, sizeof(ticks) - 1);
+            _out.integer(anchor.ticks);
+            static const char wall[] = ",\"wall_ns\":";
+            _out.write(wall, sizeof(wall) - 1);
+            _out.integer(anchor.wall);
+            static const char uncertainty[] = ",\"uncertainty_ns\":";
+            _out.write(uncertainty, sizeof(uncertainty) - 1);
+            _out.integer(anchor.uncertainty);
+            _out.write("}}", 2);
+        }
+
+        /**
+         *    @brief End the document and flush it to the stream. Called by the destructor.
+         */
+        inline void finish()
+        {
+            if (_finished)
+                return;
+            _finished = true;
+            static const char footer[] = "\n]}\n";
+            _out.write(footer, sizeof(footer) - 1);
+            _out.flush();
+        }
+
+    private:
+        inline void microseconds(std::int64_t nanoseconds)
+        {
+            if (nanoseconds < 0) {
+                _out.put('-');
+                nanoseconds = -nanoseconds;
+            }
+            _out.integer(nanoseconds / 1000);
+            _out.put('.');
+            _out.integer(nanoseconds % 1000, 3);
+        }
+
+        const std::string &escapedName(std::uint32_t nameId)
+        {
+            if (nameId >= _escapedNames.size()) {
+                _escapedNames.resize(nameId + 1);
+                _resolved.resize(nameId + 1, false);
+            }
+            if (!_resolved[nameId]) {
+                _resolved[nameId] = true;
+                std::string &escaped = _escapedNames[nameId];
+                static const char hex[] = "0123456789abcdef";
+                for (char c : _names(nameId)) {
+                    if (c == '"' || c == '\\') {
+                        escaped.push_back('\\');
+                        escaped.push_back(c);
+                    } else if (static_cast<unsigned char>(c) < 0x20) {
+                        escaped.append("\\u00");
+                        escaped.push_back(hex[(c >> 4) & 0xF]);
+                        escaped.push_back(hex[c & 0xF]);
+                    } else {
+                        escaped.push_back(c);
+                    }
+                }
+            }
+            return _escapedNames[nameId];
+        }
+
+        detail::TraceOutput         _out;           ///< The buffered output.
+        NameResolver                _names;         ///< The resolver of the section names.
+        std::uint32_t               _pid;           ///< The process identifier.
+        bool                        _first;         ///< Tells if no event has been written yet.
+        bool                        _finished;      ///< Tells if the document has been ended.
+        std::vector<std::string>    _escapedNames;  ///< The JSON-escaped names, by identifier.
+        std::vector<bool>           _resolved;      ///< Tells which names have already been resolved.
+    };
+
+
+
+    /**
+     *    @brief The PerfettoTraceWriter class streams timing events in the Perfetto protobuf trace format, readable by
+     *    ui.perfetto.dev and trace_processor.
+     *
+     *    Each event becomes a slice begin and a slice end track event on the track of its thread; section names are
+     *    interned, so each is written once. Packets are appended to the stream as they are encoded, in chunks.
+     *    Timestamps are tagged with the monotonic clock, the one of std::chrono::steady_clock on Linux, rather than
+     *    the boot time clock trace_processor assumes by default. The writer is a consumer for EventRecorder::drain().
+     */
+    class PerfettoTraceWriter {
+    public:
+        /**
+         *    @param out The output stream; it must outlive the writer.
+         *    @param names The resolver of the section names, called once per identifier.
+         *    @param pid The process identifier written into the thread tracks.
+         */
+        explicit PerfettoTraceWriter(std::ostream &out, NameResolver names = detail::RegisteredNames(), std::uint32_t pid = 0)
+            : _out(out), _names(std::move(names)), _pid(pid), _first(true) { }
+
+        PerfettoTraceWriter(const PerfettoTraceWriter &) = delete;
+        PerfettoTraceWriter &operator=(const PerfettoTraceWriter &) = delete;
+
+        ~PerfettoTraceWriter()
+        {
+            finish();
+        }
+
+        /**
+         *    @brief Append an event.
+         */
+        void write(const TimingEvent &event)
+        {
+            std::uint64_t track = TrackUuidBase + event.threadId;
+            if (event.threadId >= _tracks.size())
+                _tracks.resize(event.threadId + 1, false);
+            if (!_tracks[event.threadId]) {
+                _tracks[event.threadId] = true;
+                writeTrackDescriptor(event.threadId);
+            }
+
+            _interned.clear();
+            if (event.nameId >= _internedNames.size())
+                _internedNames.resize(event.nameId + 1, false);
+            if (!_internedNames[event.nameId]) {
+                _internedNames[event.nameId] = true;
+                _message.clear();
+                detail::AppendVarintField(_message, 1, NameIid(event.nameId));
+                detail::AppendBytesField(_message, 2, _names(event.nameId));
+                detail::AppendBytesField(_interned, 2, _message);
+            }
+
+            writeSlice(event.start, SliceBegin, track, NameIid(event.nameId), _interned);
+            _interned.clear();
+            writeSlice(event.end, SliceEnd, track, 0, _interned);
+        }
+
+        inline void operator()(const TimingEvent &event)
+        {
+            write(event);
+        }
+
+        /**
+         *    @brief Append a clock anchor of the event ticks, as a clock snapshot pairing the trace clock with the realtime
+         *    clock, which trace_processor uses to convert the timestamps of the trace.
+         */
+        void writeAnchor(const ClockAnchor &anchor)
+        {
+            _message.clear();
+            _interned.clear();
+            detail::AppendVarintField(_interned, 1, TraceClock);         // Clock.clock_id
+            detail::AppendVarintField(_interned, 2, static_cast<std::uint64_t>(anchor.ticks));  // Clock.timestamp
+            detail::AppendBytesField(_message, 1, _interned);           // ClockSnapshot.clocks
+            _interned.clear();
+            detail::AppendVarintField(_interned, 1, RealtimeClock);      // Clock.clock_id
+            detail::AppendVarintField(_interned, 2, static_cast<std::uint64_t>(anchor.wall));   // Clock.timestamp
+            detail::AppendBytesField(_message, 1, _interned);           // ClockSnapshot.clocks
+            _packet.clear();
+            detail::AppendVarintField(_packet, 10, SequenceId);         // TracePacket.trusted_packet_sequence_id
+            detail::AppendBytesField(_packet, 6, _message);             // TracePacket.clock_snapshot
+            writePacket();
+        }
+
+        /**
+         *    @brief Flush the buffered packets to the stream. Called by the destructor.
+         */
+        inline void finish()
+        {
+            _out.flush();
+        }
+
+    private:
+        static const std::uint64_t  TrackUuidBase       = 0x70726f6300000000ULL;   ///< The uuid of the track of thread 0.
+        static const std::uint32_t  SequenceId          = 1;    ///< The trusted packet sequence identifier.
+        static const std::uint32_t  SliceBegin          = 1;    ///< TrackEvent.Type.TYPE_SLICE_BEGIN.
+        static const std::uint32_t  SliceEnd            = 2;    ///< TrackEvent.Type.TYPE_SLICE_END.
+        static const std::uint32_t  StateCleared        = 1;    ///< TracePacket.SequenceFlags.SEQ_INCREMENTAL_STATE_CLEARED.
+        static const std::uint32_t  NeedsState          = 2;    ///< TracePacket.SequenceFlags.SEQ_NEEDS_INCREMENTAL_STATE.
+        static const std::uint32_t  RealtimeClock       = 1;    ///< BuiltinClock.BUILTIN_CLOCK_REALTIME.
+        static const std::uint32_t  TraceClock          = 3;    ///< BuiltinClock.BUILTIN_CLOCK_MONOTONIC, the clock of the timestamps.
+
+        static inline std::uint64_t NameIid(std::uint32_t nameId)
+        {
+            return static_cast<std::uint64_t>(nameId) + 1;
+        }
+
+        void writeTrackDescriptor(std::uint32_t threadId)
+        {
+            _message.clear();
+            detail::AppendVarintField(_message, 1, _pid);               // ThreadDescriptor.pid
+            detail::AppendVarintField(_message, 2, threadId);           // ThreadDescriptor.tid
+            _interned.clear();
+            detail::AppendVarintField(_interned, 1, TrackUuidBase + threadId);  // TrackDescriptor.uuid
+            detail::AppendBytesField(_interned, 4, _message);           // TrackDescriptor.thread
+            _packet.clear();
+            detail::AppendVarintField(_packet, 10, SequenceId);         // TracePacket.trusted_packet_sequence_id
+            if (_first) {
+                detail::AppendVarintField(_packet, 13, StateCleared);   // TracePacket.sequence_flags
+                _first = false;
+            }
+            detail::AppendBytesField(_packet, 60, _interned);           // TracePacket.track_descriptor
+            writePacket();
+        }
+
+        void writeSlice(std::int64_t timestamp, std::uint32_t type, std::uint64_t track, std::uint64_t nameIid, const std::string &interned)
+        {
+            _message.clear();
+            detail::AppendVarintField(_message, 9, type);               // TrackEvent.type
+            if (nameIid != 0)
+                detail::AppendVarintField(_message, 10, nameIid);       // TrackEvent.name_iid
+            detail::AppendVarintField(_message, 11, track);             // TrackEvent.track_uuid
+            _packet.clear();
+            detail::AppendVarintField(_packet, 8, static_cast<std::uint64_t>(timestamp));   // TracePacket.timestamp
+            detail::AppendVarintField(_packet, 10, SequenceId);         // TracePacket.trusted_packet_sequence_id
+            detail::AppendBytesField(_packet, 11, _message);            // TracePacket.track_event
+            if (!interned.empty())
+                detail::AppendBytesField(_packet, 12, interned);        // TracePacket.interned_data
+            detail::AppendVarintField(_packet, 13, NeedsState);         // TracePacket.sequence_flags
+            detail::AppendVarintField(_packet, 58, TraceClock);         // TracePacket.timestamp_clock_id
+            writePacket();
+        }
+
+        void writePacket()
+        {
+            _frame.clear();
+            detail::AppendVarint(_frame, (1u << 3) | 2);               // Trace.packet
+            detail::AppendVarint(_frame, _packet.size());
+            _out.write(_frame);
+            _out.write(_packet);
+        }
+
+        detail::TraceOutput     _out;           ///< The buffered output.
+        NameResolver            _names;         ///< The resolver of the section names.
+        std::uint32_t           _pid;           ///< The process identifier.
+        bool                    _first;         ///< Tells if no packet has been written yet.
+        std::vector<bool>       _tracks;        ///< Tells which thread tracks have been described.
+        std::vector<bool>       _internedNames; ///< Tells which names have been interned.
+        std::string             _packet;        ///< Scratch buffer for the packet being encoded.
+        std::string             _message;       ///< Scratch buffer for nested messages.
+        std::string             _interned;      ///< Scratch buffer for the interned data.
+        std::string             _frame;         ///< Scratch buffer for the packet framing.
+    };
+
+}
+
+#endif // process_timing_trace_export_hpp
@@ -0,0 +1,162 @@
+#ifndef process_timing_tsc_clock_hpp
+#define process_timing_tsc_clock_hpp
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define PROCESS_TIMING_HAS_TSC_CLOCK 1
+    #define PROCESS_TIMING_TSC_X86 1
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+        #include <cpuid.h>
+    #endif
+#elif defined(__aarch64__)
+    #define PROCESS_TIMING_HAS_TSC_CLOCK 1
+    #define PROCESS_TIMING_TSC_ARM64 1
+#endif
+
+#ifdef PROCESS_TIMING_HAS_TSC_CLOCK
+
+namespace timings {
+
+    /**
+     *    @brief The TscClock class is a steady clock reading the CPU time-stamp counter (rdtscp on x86, cntvct_el0 on ARM64).
+     *
+     *    Ticks are converted to nanoseconds with a fixed-point multiplier computed once, at the first use of the clock
+     *    (or at the first call to calibration()). On x86 the counter frequency is measured against std::chrono::steady_clock,
+     *    which takes a few milliseconds; on ARM64 it is read from cntfrq_el0.
+     *    The clock is only meaningful on CPUs whose counter is invariant, i.e. constant-rate and synchronized across cores.
+     */
+    class TscClock {
+    public:
+        using rep           = std::int64_t;
+        using period        = std::nano;
+        using duration      = std::chrono::duration<rep,period>;
+        using time_point    = std::chrono::time_point<TscClock>;
+
+        static constexpr bool is_steady = true;
+
+        /**
+         *    @brief The Calibration struct holds the counter frequency and the fixed-point factor converting ticks into nanoseconds.
+         */
+        struct Calibration {
+            std::uint64_t   frequency;  ///< Counter ticks per second.
+            std::uint64_t   multiplier; ///< Nanoseconds per tick, as a fixed-point number with shift fractional bits.
+            unsigned        shift;      ///< Number of fractional bits of multiplier.
+            bool            invariant;  ///< Tells if the CPU reports an invariant counter.
+
+            /**
+             *    @brief Convert counter ticks into nanoseconds.
+             */
+            inline rep toNanoseconds(std::uint64_t ticks) const
+            {
+#if defined(__SIZEOF_INT128__)
+                __extension__ typedef unsigned __int128 Wide;
+                return static_cast<rep>((static_cast<Wide>(ticks) * multiplier) >> shift);
+#elif defined(_MSC_VER) && defined(_M_X64)
+                std::uint64_t high;
+                std::uint64_t low = _umul128(ticks, multiplier, &high);
+                return static_cast<rep>(__shiftright128(low, high, static_cast<unsigned char>(shift)));
+#else
+                return static_cast<rep>(static_cast<long double>(ticks) * multiplier / (1ULL << shift));
+#endif
+            }
+        };
+
+        /**
+         *    @brief Return the current raw counter value.
+         */
+        static inline std::uint64_t ticks()
+        {
+#if defined(PROCESS_TIMING_TSC_X86)
+            unsigned int aux;
+            return __rdtscp(&aux);
+#else
+            std::uint64_t value;
+            asm volatile("isb\n\tmrs %0, cntvct_el0" : "=r"(value) : : "memory");
+            return value;
+#endif
+        }
+
+        /**
+         *    @brief Return the current time point.
+         */
+        static inline time_point now()
+        {
+            return time_point(duration(calibration().toNanoseconds(ticks())));
+        }
+
+        /**
+         *    @brief Return the calibration, computing it at the first call.
+         */
+        static const Calibration &calibration()
+        {
+            static const Calibration calibration = Calibrate();
+            return calibration;
+        }
+
+        /**
+         *    @brief Tells if the CPU reports an invariant counter, so that the clock is usable across cores and frequency changes.
+         */
+        static inline bool isInvariant()
+        {
+            return calibration().invariant;
+        }
+
+    private:
+        static Calibration Calibrate()
+        {
+            Calibration calibration;
+            calibration.shift = 32;
+#if defined(PROCESS_TIMING_TSC_X86)
+            calibration.invariant = InvariantTsc();
+            using Reference = std::chrono::steady_clock;
+            const Reference::duration window = std::chrono::milliseconds(20);
+            Reference::time_point referenceStart = Reference::now();
+            std::uint64_t ticksStart = ticks();
+            Reference::time_point referenceEnd;
+            do {
+                referenceEnd = Reference::now();
+            } while (referenceEnd - referenceStart < window);
+            std::uint64_t ticksEnd = ticks();
+            double nanoseconds = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(referenceEnd - referenceStart).count());
+            calibration.frequency = static_cast<std::uint64_t>(static_cast<double>(ticksEnd - ticksStart) * 1e9 / nanoseconds + 0.5);
+#else
+            calibration.invariant = true;
+            std::uint64_t frequency;
+            asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+            calibration.frequency = frequency;
+#endif
+            calibration.multiplier = static_cast<std::uint64_t>((1000000000.0 * static_cast<double>(1ULL << calibration.shift)) / static_cast<double>(calibration.frequency) + 0.5);
+            return calibration;
+        }
+
+#if defined(PROCESS_TIMING_TSC_X86)
+        static bool InvariantTsc()
+        {
+            unsigned int regs[4] = { 0, 0, 0, 0 };
+#if defined(_MSC_VER)
+            int info[4];
+            __cpuid(info, 0x80000000);
+            if (static_cast<unsigned int>(info[0]) < 0x80000007u)
+                return false;
+            __cpuid(info, 0x80000007);
+            regs[3] = static_cast<unsigned int>(info[3]);
+#else
+            if (__get_cpuid_max(0x80000000u, nullptr) < 0x80000007u)
+                return false;
+            __get_cpuid(0x80000007u, &regs[0], &regs[1], &regs[2], &regs[3]);
+#endif
+            return (regs[3] & (1u << 8)) != 0;
+        }
+#endif
+    };
+
+}
+
+#endif // PROCESS_TIMING_HAS_TSC_CLOCK
+
+#endif // process_timing_tsc_clock_hpp
@@ -0,0 +1,360 @@
+#ifndef process_timing_zones_hpp
+#define process_timing_zones_hpp
+
+#include "name_registry.hpp"
+#include "platform.hpp"
+#include "process_timing.hpp"
+#include "scoped_timing.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifndef PROCESS_TIMING_ZONE_NODES
+    /// The maximum number of distinct call paths each thread can profile.
+    #define PROCESS_TIMING_ZONE_NODES 1024
+#endif
+
+#ifndef PROCESS_TIMING_ZONE_DEPTH
+    /// The maximum nesting depth of zones whose parent is tracked.
+    #define PROCESS_TIMING_ZONE_DEPTH 128
+#endif
+
+namespace timings {
+
+    namespace detail {
+
+        /**
+         *    @brief The ZoneNode struct accumulates the timings of a zone reached through a given path of parent zones.
+         */
+        struct ZoneNode {
+            std::uint32_t               zoneId;         ///< The name identifier of the zone.
+            std::uint32_t               parent;         ///< The index of the parent node.
+            std::uint32_t               nextSibling;    ///< The index of the next child of the parent node, or None.
+            std::atomic<std::uint32_t>  firstChild;     ///< The index of the first child node, or None.
+            std::atomic<std::uint64_t>  calls;          ///< The number of completed executions.
+            std::atomic<std::uint64_t>  inclusive;      ///< The total time, in nanoseconds, including children zones.
+            std::atomic<std::uint64_t>  children;       ///< The total time, in nanoseconds, spent in children zones.
+        };
+
+        /**
+         *    @brief The ZoneThreadProfile class holds the call tree of the zones of one thread, with its stack of open zones.
+         *
+         *    Only the owner thread writes; other threads may read the published nodes at any time.
+         */
+        class ZoneThreadProfile {
+        public:
+            static const std::uint32_t  Capacity    = PROCESS_TIMING_ZONE_NODES;   ///< The maximum number of nodes.
+            static const std::uint32_t  Depth       = PROCESS_TIMING_ZONE_DEPTH;   ///< The maximum tracked nesting depth.
+            static const std::uint32_t  None        = 0xFFFFFFFFu;  ///< The index of no node.
+            static const std::uint32_t  Root        = 0;            ///< The index of the root node, parent of top-level zones.
+            static const std::uint32_t  Overflow    = 1;            ///< The index of the node collecting the zones beyond capacity.
+
+            ZoneThreadProfile() : next(nullptr), owned(true), _size(0), _depth(0)
+            {
+                create(None, None);
+                create(NameRegistry::Overflow, Root);
+            }
+
+            ZoneThreadProfile(const ZoneThreadProfile &) = delete;
+            ZoneThreadProfile &operator=(const ZoneThreadProfile &) = delete;
+
+            /**
+             *    @brief Open a zone as child of the innermost open one.
+             *    @return The index of the node of the zone.
+             */
+            inline std::uint32_t enter(std::uint32_t zoneId)
+            {
+                std::uint32_t parent = _depth == 0 ? Root : _stack[(_depth < Depth ? _depth : Depth) - 1];
+                std::uint32_t node = _nodes[parent].firstChild.load(std::memory_order_relaxed);
+                while (node != None && _nodes[node].zoneId != zoneId)
+                    node = _nodes[node].nextSibling;
+                if (node == None)
+                    node = create(zoneId, parent);
+                if (_depth < Depth)
+                    _stack[_depth] = node;
+                ++_depth;
+                return node;
+            }
+
+            /**
+             *    @brief Close the innermost open zone.
+             *    @param node The index of the node of the zone, as returned by enter().
+             *    @param nanoseconds The time spent in the zone.
+             */
+            inline void exit(std::uint32_t node, std::uint64_t nanoseconds)
+            {
+                ZoneNode &zone = _nodes[node];
+                AddRelaxed(zone.calls, 1);
+                AddRelaxed(zone.inclusive, nanoseconds);
+                AddRelaxed(_nodes[zone.parent].children, nanoseconds);
+                --_depth;
+            }
+
+            /**
+             *    @brief Return the number of published nodes.
+             */
+            inline std::uint32_t size() const
+            {
+                return _size.load(std::memory_order_acquire);
+            }
+
+            /**
+             *    @brief Return a published node.
+             */
+            inline const ZoneNode &node(std::uint32_t index) const
+            {
+                return _nodes[index];
+            }
+
+            ZoneThreadProfile  *next;   ///< The next profile of the profiler list.
+            std::atomic<bool>   owned;  ///< Tells if a thread records into the profile.
+
+        private:
+            std::uint32_t create(std::uint32_t zoneId, std::uint32_t parent)
+            {
+                std::uint32_t index = _size.load(std::memory_order_relaxed);
+                if (index == Capacity)
+                    return Overflow;
+                ZoneNode &node = _nodes[index];
+                node.zoneId = zoneId;
+                node.parent = parent;
+                node.firstChild.store(None, std::memory_order_relaxed);
+                node.calls.store(0, std::memory_order_relaxed);
+                node.inclusive.store(0, std::memory_order_relaxed);
+                node.children.store(0, std::memory_order_relaxed);
+                if (parent != None) {
+                    node.nextSibling = _nodes[parent].firstChild.load(std::memory_order_relaxed);
+                    _nodes[parent].firstChild.store(index, std::memory_order_release);
+                } else {
+                    node.nextSibling = None;
+                }
+                _size.store(index + 1, std::memory_order_release);
+                return index;
+            }
+
+            ZoneNode                    _nodes[Capacity];   ///< The nodes of the call tree; node 0 is the root.
+            std::atomic<std::uint32_t>  _size;              ///< The number of published nodes.
+            std::uint32_t               _stack[Depth];      ///< The nodes of the open zones, innermost last.
+            std::uint32_t               _depth;             ///< The number of open zones.
+        };
+
+    }
+
+
+
+    /**
+     *    @brief The ZoneStats struct holds the merged timings of a zone reached through a given path of parent zones.
+     */
+    struct ZoneStats {
+        std::uint32_t               zoneId;     ///< The name identifier of the zone.
+        std::uint32_t               parent;     ///< The index of the parent zone in the tree, or ZoneTree::None for top-level zones.
+        std::uint64_t               calls;      ///< The number of completed executions.
+        std::chrono::nanoseconds    inclusive;  ///< The total time, including children zones.
+        std::chrono::nanoseconds    self;       ///< The total time, excluding children zones.
+    };
+
+
+
+    /**
+     *    @brief The ZoneTree class is a call-tree profile of zones, merged across threads; parents precede their children.
+     */
+    class ZoneTree {
+    public:
+        static const std::uint32_t None = 0xFFFFFFFFu;  ///< The parent index of top-level zones.
+
+        std::vector<ZoneStats>  zones;  ///< The zones of the tree.
+
+        /**
+         *    @brief Write the tree as indented text, one zone per line, with its calls, inclusive and self times.
+         */
+        void write(std::ostream &out, const NameRegistry &names = NameRegistry::Global()) const
+        {
+            std::vector<std::vector<std::uint32_t>> children(zones.size() + 1);
+            for (std::uint32_t i = 0; i < zones.size(); ++i)
+                children[zones[i].parent == None ? zones.size() : zones[i].parent].push_back(i);
+            std::vector<std::pair<std::uint32_t, std::size_t>> stack;
+            for (std::size_t i = children.back().size(); i > 0; --i)
+                stack.push_back(std::make_pair(children.back()[i - 1], std::size_t(0)));
+            std::string inclusive, self;
+            while (!stack.empty()) {
+                std::uint32_t index = stack.back().first;
+                std::size_t depth = stack.back().second;
+                stack.pop_back();
+                const ZoneStats &zone = zones[index];
+                const char *name = names.name(zone.zoneId);
+                ProcessTimingBase::TimeToString(zone.inclusive, inclusive);
+                ProcessTimingBase::TimeToString(zone.self, self);
+                out << std::string(2 * depth, ' ') << (name != nullptr ? name : "<overflow>")
+                    << "  calls=" << zone.calls << "  inclusive=" << inclusive << "  self=" << self << '\n';
+                for (std::size_t i = children[index].size(); i > 0; --i)
+                    stack.push_back(std::make_pair(children[index][i - 1], depth + 1));
+            }
+        }
+    };
+
+
+
+    /**
+     *    @brief The ZoneProfiler class owns the zone profiles of all threads and merges them into call trees.
+     */
+    class ZoneProfiler {
+    public:
+        ZoneProfiler() : _profiles(nullptr) { }
+
+        ZoneProfiler(const ZoneProfiler &) = delete;
+        ZoneProfiler &operator=(const ZoneProfiler &) = delete;
+
+        /**
+         *    @brief Return the process-wide profiler. It is never destroyed.
+         */
+        static ZoneProfiler &Global()
+        {
+            static ZoneProfiler *profiler = detail::NewPermanent<ZoneProfiler>();
+            return *profiler;
+        }
+
+        /**
+         *    @brief Return the profile of the calling thread, taking it from the global profiler at the first call.
+         */
+        static detail::ZoneThreadProfile &Local()
+        {
+            thread_local ThreadProfile local(Global().acquire());
+            return *local.profile;
+        }
+
+        /**
+         *    @brief Merge the profiles of all threads into a call tree. Zones still open are not accounted.
+         */
+        ZoneTree snapshot() const
+        {
+            using Profile = detail::ZoneThreadProfile;
+            ZoneTree tree;
+            std::map<std::pair<std::uint32_t, std::uint32_t>, std::uint32_t> merged;
+            std::vector<std::uint32_t> mapping;
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (const Profile *profile = _profiles; profile != nullptr; profile = profile->next) {
+                std::uint32_t size = profile->size();
+                mapping.assign(size, static_cast<std::uint32_t>(ZoneTree::None));
+                for (std::uint32_t i = Profile::Root + 1; i < size; ++i) {
+                    const detail::ZoneNode &node = profile->node(i);
+                    std::uint64_t calls = node.calls.load(std::memory_order_relaxed);
+                    if (calls == 0 && node.firstChild.load(std::memory_order_relaxed) == Profile::None)
+                        continue;
+                    std::uint32_t parent = node.parent == Profile::Root ? ZoneTree::None : mapping[node.parent];
+                    std::pair<std::uint32_t, std::uint32_t> key(parent, node.zoneId);
+                    auto it = merged.find(key);
+                    if (it == merged.end()) {
+                        ZoneStats stats = { node.zoneId, parent, 0, std::chrono::nanoseconds::zero(), std::chrono::nanoseconds::zero() };
+                        it = merged.insert(std::make_pair(key, static_cast<std::uint32_t>(tree.zones.size()))).first;
+                        tree.zones.push_back(stats);
+                    }
+                    mapping[i] = it->second;
+                    std::uint64_t inclusive = node.inclusive.load(std::memory_order_relaxed);
+                    std::uint64_t children = node.children.load(std::memory_order_relaxed);
+                    ZoneStats &stats = tree.zones[it->second];
+                    stats.calls += calls;
+                    stats.inclusive += std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(inclusive));
+                    stats.self += std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(inclusive > children ? inclusive - children : 0));
+                }
+            }
+            return tree;
+        }
+
+    private:
+        struct ThreadProfile {
+            explicit ThreadProfile(detail::ZoneThreadProfile *acquired) : profile(acquired) { }
+
+            ~ThreadProfile()
+            {
+                profile->owned.store(false, std::memory_order_release);
+            }
+
+            detail::ZoneThreadProfile  *profile;    ///< The profile of the thread.
+        };
+
+        detail::ZoneThreadProfile *acquire()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (detail::ZoneThreadProfile *profile = _profiles; profile != nullptr; profile = profile->next) {
+                bool owned = false;
+                if (profile->owned.compare_exchange_strong(owned, true, std::memory_order_acquire))
+                    return profile;
+            }
+            detail::ZoneThreadProfile *profile = detail::NewPermanent<detail::ZoneThreadProfile>();
+            profile->next = _profiles;
+            _profiles = profile;
+            return profile;
+        }
+
+        mutable std::mutex          _mutex;     ///< Protects the list of profiles.
+        detail::ZoneThreadProfile  *_profiles;  ///< The list of profiles, grown at its head.
+    };
+
+
+
+    /**
+     *    @brief The BasicZone class times its own lifetime as a zone of the call-tree profile of the calling thread, child of
+     *    the innermost zone open when it is constructed. It must be destroyed by the thread that constructed it.
+     */
+    template < class ClockType >
+    class BasicZone {
+    public:
+        using Clock     = ClockType;
+        using TimePoint = typename Clock::time_point;
+
+        /**
+         *    @param zoneId The name identifier of the zone, as returned by NameRegistry::intern().
+         */
+        explicit BasicZone(std::uint32_t zoneId) : _profile(ZoneProfiler::Local()), _node(_profile.enter(zoneId)), _start(Clock::now()) { }
+
+        BasicZone(const BasicZone &) = delete;
+        BasicZone &operator=(const BasicZone &) = delete;
+
+        ~BasicZone()
+        {
+            std::chrono::nanoseconds::rep elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - _start).count();
+            _profile.exit(_node, elapsed > 0 ? static_cast<std::uint64_t>(elapsed) : 0);
+        }
+
+    private:
+        detail::ZoneThreadProfile  &_profile;   ///< The profile of the thread.
+        std::uint32_t               _node;      ///< The index of the node of the zone.
+        TimePoint                   _start;     ///< The initial time point.
+    };
+
+
+
+    /// The default zone class, measuring with std::chrono::steady_clock.
+    using Zone = BasicZone<std::chrono::steady_clock>;
+
+}
+
+
+
+#ifdef __COUNTER__
+    #define PROCESS_TIMING_ZONE(name) PROCESS_TIMING_ZONE_IMPL(name, __COUNTER__)
+#else
+    #define PROCESS_TIMING_ZONE(name) PROCESS_TIMING_ZONE_IMPL(name, __LINE__)
+#endif
+
+/**
+ *    @brief PROCESS_TIMING_ZONE(name) profiles the rest of the enclosing scope as a zone; the name is interned once, at the
+ *    first execution. When PROCESS_TIMING_DISABLE is defined, it expands to nothing.
+ */
+#ifdef PROCESS_TIMING_DISABLE
+    #define PROCESS_TIMING_ZONE_IMPL(name, unique) static_cast<void>(0)
+#else
+    #define PROCESS_TIMING_ZONE_IMPL(name, unique) \
+        static const std::uint32_t PROCESS_TIMING_CONCAT(processTimingZoneId, unique) = ::timings::NameRegistry::Global().intern(name); \
+        ::timings::Zone PROCESS_TIMING_CONCAT(processTimingZone, unique)(PROCESS_TIMING_CONCAT(processTimingZoneId, unique))
+#endif
+
+#endif // process_timing_zones_hpp
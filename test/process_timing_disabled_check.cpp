@@ -0,0 +1,102 @@
+// Built with PROCESS_TIMING_DISABLE defined: the disabled timings must neither read a clock nor touch a sink, which
+// is checked both at compile time, by evaluating them in constant expressions, and at link time, by a clock and a sink
+// whose functions are declared but never defined.
+
+#include <process_timing/deadline.hpp>
+#include <process_timing/event_recorder.hpp>
+#include <process_timing/process_timing.hpp>
+#include <process_timing/sampled_timing.hpp>
+#include <process_timing/scoped_timing.hpp>
+#include <process_timing/timing_registry.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <type_traits>
+
+#ifndef PROCESS_TIMING_DISABLE
+    #error "process_timing_disabled_check must be built with PROCESS_TIMING_DISABLE defined"
+#endif
+
+using namespace timings;
+
+namespace {
+
+    /**
+     *    @brief A clock whose now() is not defined: reading it fails to link.
+     */
+    struct UndefinedClock {
+        using rep           = std::int64_t;
+        using period        = std::nano;
+        using duration      = std::chrono::duration<rep, period>;
+        using time_point    = std::chrono::time_point<UndefinedClock>;
+
+        static constexpr bool is_steady = true;
+
+        static time_point now();
+    };
+
+    /**
+     *    @brief A sink whose record() is not defined: recording into it fails to link.
+     */
+    struct UndefinedSink {
+        template < typename Rep, typename Period >
+        void record(const std::chrono::duration<Rep,Period> &duration);
+
+        template < typename Rep, typename Period >
+        void record(const std::chrono::duration<Rep,Period> &duration, std::uint64_t weight);
+    };
+
+    static_assert(std::is_same<ProcessTiming, NullProcessTiming>::value, "ProcessTiming must be disabled");
+    static_assert(std::is_same<LocalProcessTiming, NullProcessTiming>::value, "LocalProcessTiming must be disabled");
+
+    template < class Timing >
+    constexpr long long TimeSection()
+    {
+        Timing timing;
+        timing.start();
+        timing.stop();
+        UndefinedSink sink;
+        timing.start();
+        timing.stop(sink);
+        return static_cast<long long>(timing.elapsed().count() + timing.elapsed(std::chrono::nanoseconds(1)).count()) + (timing.isRunning() ? 1 : 0);
+    }
+
+    static_assert(TimeSection<ProcessTiming>() == 0, "disabled timings must not read the clock");
+    static_assert(TimeSection<BasicNullProcessTiming<UndefinedClock>>() == 0, "disabled timings must not read the clock");
+
+    long long Instrumented(long long value)
+    {
+        UndefinedSink sink;
+        PROCESS_TIMING_SCOPE(sink);
+        PROCESS_TIMING_SAMPLED_SCOPE(sink, 16);
+        PROCESS_TIMING_GEOMETRIC_SCOPE(sink, 16);
+        PROCESS_TIMING_EVENT_SCOPE(1u);
+        PROCESS_TIMING_REGISTERED_SCOPE("disabled");
+        BasicNullProcessTiming<UndefinedClock> timing;
+        timing.start();
+        value = value * 3 + 1;
+        timing.stop(sink);
+        return value + TimeSection<ProcessTiming>() + TimeSection<BasicNullProcessTiming<UndefinedClock>>() + static_cast<long long>(timing.to_time_string().size());
+    }
+
+}
+
+int main()
+{
+    // A deadline built from a disabled timing still enforces its budget, from now.
+    ProcessTiming timing;
+    Deadline deadline(timing, std::chrono::hours(1));
+    Deadline expired(timing, std::chrono::nanoseconds::zero());
+    if (deadline.expired() || !expired.expired()) {
+        std::fprintf(stderr, "deadlines of disabled timings do not enforce their budgets\n");
+        return 1;
+    }
+
+    long long value = Instrumented(2);
+    long long expected = 7 + static_cast<long long>(NullProcessTiming().to_time_string().size());
+    if (value != expected) {
+        std::fprintf(stderr, "disabled timings changed the instrumented result: %lld instead of %lld\n", value, expected);
+        return 1;
+    }
+    return 0;
+}
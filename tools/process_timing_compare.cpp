@@ -0,0 +1,84 @@
+#include <process_timing/bench.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace timings;
+
+namespace {
+
+    bool Load(const char *path, std::vector<bench::Result> &results)
+    {
+        std::ifstream in(path);
+        if (!in || !bench::ReadJson(in, results)) {
+            std::cerr << path << ": not a benchmark results file\n";
+            return false;
+        }
+        return true;
+    }
+
+    bool Option(const char *arg, const char *prefix, double &value)
+    {
+        std::size_t length = std::strlen(prefix);
+        if (std::strncmp(arg, prefix, length) != 0)
+            return false;
+        value = std::strtod(arg + length, nullptr);
+        return true;
+    }
+
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        std::cerr << "usage: " << argv[0] << " <baseline json> <candidate json> [--threshold=<fraction>] [--alpha=<level>] [--resamples=<n>]\n";
+        return 2;
+    }
+    bench::CompareOptions options;
+    for (int i = 3; i < argc; ++i) {
+        double resamples = 0.0;
+        if (Option(argv[i], "--threshold=", options.threshold) || Option(argv[i], "--alpha=", options.alpha)) {
+        } else if (Option(argv[i], "--resamples=", resamples)) {
+            options.resamples = static_cast<std::size_t>(resamples);
+        } else {
+            std::cerr << "unknown argument: " << argv[i] << '\n';
+            return 2;
+        }
+    }
+
+    std::vector<bench::Result> baseline, candidate;
+    if (!Load(argv[1], baseline) || !Load(argv[2], candidate))
+        return 2;
+
+    std::printf("%-48s %14s %14s %9s %20s %9s  %s\n", "benchmark", "baseline", "candidate", "change", "interval", "p", "verdict");
+    std::size_t regressions = 0;
+    for (const bench::Result &result : candidate) {
+        const bench::Result *base = nullptr;
+        for (const bench::Result &other : baseline)
+            if (other.name == result.name)
+                base = &other;
+        if (base == nullptr) {
+            std::printf("%-48s %14s %11.2f ns %9s %20s %9s  new\n", result.name.c_str(), "-", result.median, "", "", "");
+            continue;
+        }
+        bench::Comparison comparison = bench::Compare(*base, result, options);
+        char interval[32];
+        std::snprintf(interval, sizeof(interval), "[%+.1f%%, %+.1f%%]", 100.0 * comparison.lower, 100.0 * comparison.upper);
+        const char *verdict = comparison.regression ? "REGRESSION" : comparison.improvement ? "improvement" : "";
+        std::printf("%-48s %11.2f ns %11.2f ns %+8.1f%% %20s %9.2g  %s\n", comparison.name.c_str(), comparison.baseline, comparison.candidate,
+                    100.0 * comparison.change, interval, comparison.change > 0.0 ? comparison.slower : comparison.faster, verdict);
+        if (comparison.regression)
+            ++regressions;
+    }
+
+    if (regressions > 0) {
+        std::printf("%zu significant regression%s beyond %.1f%%\n", regressions, regressions > 1 ? "s" : "", 100.0 * options.threshold);
+        return 1;
+    }
+    return 0;
+}
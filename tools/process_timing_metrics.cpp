@@ -0,0 +1,65 @@
+#include <process_timing/process_timing.hpp>
+#include <process_timing/shared_metrics.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace timings;
+
+namespace {
+
+    std::string Duration(std::uint64_t nanoseconds)
+    {
+        TimeString str = ProcessTimingBase::TimeToTimeString(std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(nanoseconds)));
+        return str.empty() ? std::string("0ns.") : str.str();
+    }
+
+    void Print(const SharedMetricsReader &reader)
+    {
+        std::printf("%-32s %12s %24s %20s %20s %20s %20s %20s\n", "metric", "count", "total", "mean", "min", "max", "p50", "p99");
+        SharedMetricSnapshot metric;
+        for (std::size_t i = 0; i < reader.size(); ++i) {
+            bool consistent = reader.read(i, metric);
+            std::uint64_t mean = metric.count > 0 ? metric.total / metric.count : 0;
+            std::printf("%-32s %12llu %24s %20s %20s %20s", metric.name.c_str(), static_cast<unsigned long long>(metric.count),
+                        Duration(metric.total).c_str(), Duration(mean).c_str(), Duration(metric.min).c_str(), Duration(metric.max).c_str());
+            if (metric.kind == SharedMetricKind::Histogram)
+                std::printf(" %20s %20s", Duration(static_cast<std::uint64_t>(metric.histogram.quantile(0.5).count())).c_str(),
+                            Duration(static_cast<std::uint64_t>(metric.histogram.quantile(0.99).count())).c_str());
+            std::printf(consistent ? "\n" : "  (torn: the slot is locked, its writer may have died)\n");
+        }
+    }
+
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <metrics file> [--watch=<milliseconds>]\n";
+        return 2;
+    }
+    long watch = 0;
+    if (argc > 2 && std::strncmp(argv[2], "--watch=", 8) == 0)
+        watch = std::strtol(argv[2] + 8, nullptr, 10);
+
+    SharedMetricsReader reader(argv[1]);
+    if (!reader.isOpen()) {
+        std::cerr << argv[1] << ": not a supported metrics file\n";
+        return 1;
+    }
+    for (;;) {
+        std::printf("process %lld\n", static_cast<long long>(reader.pid()));
+        Print(reader);
+        if (watch <= 0)
+            break;
+        std::fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::milliseconds(watch));
+        std::printf("\n");
+    }
+    return 0;
+}